@@ -16,6 +16,14 @@
 #include <map>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <system_error>
+
+#include "../../Plugin/aSWMultiplexer/slot_manifest_format.hpp"
+#include "../../Plugin/aSWMultiplexer/form_table_format.hpp"
+#include "../../Plugin/aSWMultiplexer/form_id_allocator.hpp"
+#include "../../Plugin/aSWMultiplexer/formid_ledger_format.hpp"
+#include "../../Plugin/aSWMultiplexer/glob_matcher.hpp"
 
 // ------------------------------------------------------------
 // Helpers: string utilities
@@ -307,39 +315,41 @@ bool FailOrWarn(bool strict, const std::string& msg, std::ofstream& log) {
 
 // ------------------------------------------------------------
 // Protected plugins (protected_plugins.json)
-// Very simple JSON: ["Plugin1.esp","Plugin2.esl", ...]
+// Same reader and matcher as the plugin: exact names and globs such as
+// "SS2_*.esp", case-insensitive
 // ------------------------------------------------------------
-std::unordered_set<std::string> LoadProtectedPlugins(const std::filesystem::path& jsonPath, std::ofstream& log) {
-    std::unordered_set<std::string> protectedSet;
+GlobMatcher LoadProtectedPlugins(const std::filesystem::path& jsonPath, std::ofstream& log) {
+    GlobMatcher matcher;
 
-    std::ifstream in(jsonPath);
+    std::ifstream in(jsonPath, std::ios::binary);
     if (!in) {
         log << "PROTECTED: No protected_plugins.json found at " << jsonPath.string() << " (optional).\n";
-        return protectedSet;
+        matcher.Build();
+        return matcher;
     }
 
     log << "PROTECTED: Loading protected_plugins.json from " << jsonPath.string() << "\n";
 
-    std::string content((std::istreambuf_iterator<char>(in)),
-        std::istreambuf_iterator<char>());
+    std::vector<std::string> patterns;
+    std::string error;
+    if (!ReadWhitelistPatterns(in, patterns, error)) {
+        std::string msg = "WARNING: protected_plugins.json is malformed (" + error + ") - no plugins are protected.";
+        log << msg << "\n";
+        std::cerr << msg << "\n";
+        matcher.Build();
+        return matcher;
+    }
 
-    // Very naive JSON string extractor: finds all "..." sequences
-    std::regex strRegex("\"([^\"]+)\"");
-    std::smatch match;
-    std::string::const_iterator searchStart(content.cbegin());
-
-    while (std::regex_search(searchStart, content.cend(), match, strRegex)) {
-        std::string plugin = Trim(match[1].str());
-        std::string lower = ToLower(plugin);
-        if (!lower.empty()) {
-            protectedSet.insert(lower);
-            log << "PROTECTED: Registered protected plugin '" << lower << "'\n";
-        }
-        searchStart = match.suffix().first;
+    for (const std::string& pattern : patterns) {
+        matcher.Add(pattern);
+        log << "PROTECTED: Registered protected plugin rule '" << pattern << "'\n";
     }
+    if (!matcher.Build())
+        log << "PROTECTED: " << patterns.size() << " rules exceed " << GlobMatcher::kMaxStates
+            << " DFA states - matching rules one by one.\n";
 
-    log << "PROTECTED: Total protected plugins: " << protectedSet.size() << "\n";
-    return protectedSet;
+    log << "PROTECTED: Total protected plugin rules: " << matcher.PatternCount() << "\n";
+    return matcher;
 }
 // ------------------------------------------------------------
 // Category enum for plugins
@@ -568,6 +578,413 @@ static const std::vector<DummySlotDef> DUMMY_SLOTS = {
     { "Dummy_LeveledLists_04.esp", 4004, PluginCategory::LeveledLists },
     { "Dummy_LeveledLists_05.esp", 4005, PluginCategory::LeveledLists }
 };
+// ------------------------------------------------------------
+// Binary slot manifest (slot_manifest.bin)
+// Same data as the CSV + slot.cfg, laid out so the plugin can map it and
+// read it without parsing. Format: Plugin/aSWMultiplexer/slot_manifest_format.hpp
+// ------------------------------------------------------------
+struct ManifestRow {
+    std::string dummyName;
+    std::uint32_t virtualID = 0;
+    std::string category;
+    std::vector<std::string> mods;
+};
+
+class ManifestStrings {
+public:
+    std::uint32_t Intern(const std::string& s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+
+        const std::uint32_t id = static_cast<std::uint32_t>(entries.size());
+        entries.push_back({ static_cast<std::uint32_t>(blob.size()), static_cast<std::uint32_t>(s.size()) });
+        blob.insert(blob.end(), s.begin(), s.end());
+        blob.push_back('\0');
+        ids.emplace(s, id);
+        return id;
+    }
+
+    std::vector<SlotManifestString> entries;
+    std::vector<char> blob;
+
+private:
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+static void AppendBytes(std::vector<std::uint8_t>& out, const void* data, std::size_t size) {
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    out.insert(out.end(), p, p + size);
+}
+
+// Pads to the next 8-byte boundary and returns the section offset
+static std::uint32_t BeginSection(std::vector<std::uint8_t>& out) {
+    out.resize((out.size() + 7) & ~static_cast<std::size_t>(7), 0);
+    return static_cast<std::uint32_t>(out.size());
+}
+
+// Write beside the target and rename so a reader never sees a partial file
+static bool ReplaceFileContents(const std::filesystem::path& path, const std::vector<std::uint8_t>& bytes, std::ofstream& log) {
+    std::filesystem::path tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream bin(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!bin) {
+            log << "WARNING: Failed to open " << tmpPath.string() << " for writing.\n";
+            return false;
+        }
+        bin.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!bin) {
+            log << "WARNING: Failed to write " << tmpPath.string() << ".\n";
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        log << "WARNING: Failed to replace " << path.string() << ": " << ec.message() << "\n";
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+// Must run after the CSV and slot.cfg are closed: their size and mtime are
+// recorded so the plugin can tell when either was edited afterwards.
+bool WriteSlotManifest(const std::filesystem::path& manifestPath,
+    const std::string& csvPath,
+    const std::string& slotCfgPath,
+    std::uint8_t fileIndex,
+    const std::vector<std::string>& modules,
+    const std::vector<ManifestRow>& rows,
+    const std::map<std::string, std::string>& aliasMap,
+    std::ofstream& log)
+{
+    std::error_code ec;
+    SlotManifestHeader header{};
+    std::memcpy(header.magic, kSlotManifestMagic, sizeof(header.magic));
+    header.version = kSlotManifestVersion;
+    header.headerSize = sizeof(SlotManifestHeader);
+    header.fileIndex = fileIndex;
+
+    header.csvSize = std::filesystem::file_size(csvPath, ec);
+    if (!ec) header.csvWriteTime = std::filesystem::last_write_time(csvPath, ec).time_since_epoch().count();
+    if (!ec) header.slotCfgSize = std::filesystem::file_size(slotCfgPath, ec);
+    if (!ec) header.slotCfgWriteTime = std::filesystem::last_write_time(slotCfgPath, ec).time_since_epoch().count();
+    if (ec) {
+        log << "WARNING: Could not stat CSV / slot.cfg for slot manifest: " << ec.message() << "\n";
+        return false;
+    }
+
+    ManifestStrings strings;
+
+    std::vector<std::uint32_t> moduleIds;
+    moduleIds.reserve(modules.size());
+    for (const auto& m : modules) moduleIds.push_back(strings.Intern(m));
+
+    std::vector<SlotManifestSlot> slots;
+    std::vector<std::uint32_t> slotMods;
+    slots.reserve(rows.size());
+    for (const auto& r : rows) {
+        SlotManifestSlot s{};
+        s.dummyPlugin = strings.Intern(r.dummyName);
+        s.virtualId = r.virtualID;
+        s.category = strings.Intern(r.category);
+        s.firstMod = static_cast<std::uint32_t>(slotMods.size());
+        s.modCount = static_cast<std::uint32_t>(r.mods.size());
+        for (const auto& m : r.mods) slotMods.push_back(strings.Intern(m));
+        slots.push_back(s);
+    }
+
+    std::vector<SlotManifestAlias> aliases;
+    aliases.reserve(aliasMap.size());
+    for (const auto& kv : aliasMap) aliases.push_back({ strings.Intern(kv.first), strings.Intern(kv.second) });
+
+    // Header is patched in once every offset is known
+    std::vector<std::uint8_t> out(sizeof(SlotManifestHeader), 0);
+
+    header.stringCount = static_cast<std::uint32_t>(strings.entries.size());
+    header.stringOffset = BeginSection(out);
+    AppendBytes(out, strings.entries.data(), strings.entries.size() * sizeof(SlotManifestString));
+
+    header.moduleCount = static_cast<std::uint32_t>(moduleIds.size());
+    header.moduleOffset = BeginSection(out);
+    AppendBytes(out, moduleIds.data(), moduleIds.size() * sizeof(std::uint32_t));
+
+    header.slotCount = static_cast<std::uint32_t>(slots.size());
+    header.slotOffset = BeginSection(out);
+    AppendBytes(out, slots.data(), slots.size() * sizeof(SlotManifestSlot));
+
+    header.slotModCount = static_cast<std::uint32_t>(slotMods.size());
+    header.slotModOffset = BeginSection(out);
+    AppendBytes(out, slotMods.data(), slotMods.size() * sizeof(std::uint32_t));
+
+    header.aliasCount = static_cast<std::uint32_t>(aliases.size());
+    header.aliasOffset = BeginSection(out);
+    AppendBytes(out, aliases.data(), aliases.size() * sizeof(SlotManifestAlias));
+
+    header.stringBlobSize = static_cast<std::uint32_t>(strings.blob.size());
+    header.stringBlobOffset = BeginSection(out);
+    AppendBytes(out, strings.blob.data(), strings.blob.size());
+
+    header.fileSize = static_cast<std::uint32_t>(out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    header.checksum = SlotManifestChecksum(out.data(), out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    if (!ReplaceFileContents(manifestPath, out, log))
+        return false;
+
+    log << "Slot manifest written: " << manifestPath.string()
+        << " (" << out.size() << " bytes, " << slots.size() << " rows, "
+        << strings.entries.size() << " strings)\n";
+    return true;
+}
+
+// formid_ledger.bin, read-only: folded module name -> local key ->
+// (folded dummy plugin name, object ID)
+using FormIdLedgerMap = std::unordered_map<std::string,
+    std::unordered_map<std::uint32_t, std::pair<std::string, std::uint32_t>>>;
+
+static FormIdLedgerMap LoadFormIdLedger(const std::filesystem::path& path, std::ofstream& log) {
+    FormIdLedgerMap ledger;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return ledger;
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    const std::size_t intact = FormIdLedgerParse(bytes.data(), bytes.size(),
+        [&](std::string_view module, std::string_view dummy, std::uint32_t localKey, std::uint32_t objectID) {
+            ledger[std::string(module)].insert_or_assign(localKey, std::make_pair(std::string(dummy), objectID));
+        });
+
+    if (intact < bytes.size())
+        log << "FormIdLedger: ignoring " << (bytes.size() - intact) << " damaged bytes of " << path.string() << "\n";
+    log << "FormIdLedger: " << ledger.size() << " modules with existing FormID assignments\n";
+    return ledger;
+}
+
+// One dummy slot's modules, placed as the plugin's build_form_maps places
+// them: a module's local keys, ascending, keep the object IDs the ledger
+// holds for them in this dummy plugin; the rest take the lowest IDs the
+// FormIdAllocator has free. Returns false if a module does not fit.
+static bool WriteSlotFormTable(std::uint8_t fileIndex,
+    const std::string& dummyName,
+    const std::vector<std::string>& modules,
+    const std::filesystem::path& dataPath,
+    const FormIdLedgerMap& ledger,
+    std::vector<FormTableModule>& records,
+    std::vector<FormTableEntry>& entries,
+    std::vector<std::uint32_t>& refs,
+    std::vector<char>& names)
+{
+    // Same placement as the plugin's build_form_maps: every ledger entry in
+    // this dummy plugin is taken first, then each module keeps its ledgered
+    // IDs and packs the rest into the lowest free ones
+    const std::string dummy = ToLower(dummyName);
+    FormIdAllocator ids;
+    for (const auto& [module, keys] : ledger) {
+        for (const auto& [key, placed] : keys) {
+            if (placed.first == dummy) ids.Reserve(placed.second);
+        }
+    }
+
+    std::vector<std::uint32_t> targets;
+
+    for (std::size_t i = 0; i < modules.size(); ++i) {
+        const std::string& name = modules[i];
+
+        FormTableModule rec{};
+        rec.nameOffset = static_cast<std::uint32_t>(names.size());
+        rec.nameLength = static_cast<std::uint32_t>(name.size());
+        rec.firstEntry = static_cast<std::uint32_t>(entries.size());
+        rec.firstRef = static_cast<std::uint32_t>(refs.size());
+        names.insert(names.end(), name.begin(), name.end());
+        names.push_back('\0');
+
+        const std::filesystem::path pluginFile = dataPath / name;
+        std::error_code ec;
+        rec.pluginSize = std::filesystem::file_size(pluginFile, ec);
+        if (!ec) rec.pluginWriteTime = std::filesystem::last_write_time(pluginFile, ec).time_since_epoch().count();
+
+        std::vector<std::uint8_t> bytes;
+        if (!ec) {
+            std::ifstream in(pluginFile, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            if (!in && !in.eof()) ec = std::make_error_code(std::errc::io_error);
+        }
+        if (ec) {
+            rec.pluginSize = 0;
+            rec.pluginWriteTime = 0;
+            rec.flags = kFormTableModuleMissing;
+            records.push_back(rec);
+            continue;
+        }
+
+        // What inject_records needs per record: type and, for LVLI, the LVLO FormIDs
+        struct Collected { std::uint32_t key; std::uint32_t type; std::vector<std::uint32_t> refs; };
+        std::vector<Collected> collected;
+        bool lvliCompressed = false;
+        const FormTableScan scan = FormTableScanPlugin(bytes.data(), bytes.size(),
+            [&](std::uint32_t formID, std::uint32_t type, const std::uint8_t* payload, std::uint32_t payloadSize, bool compressed) {
+                Collected c{ formID, type, {} };
+                if (type == 0x494C564Cu) {   // 'LVLI'
+                    if (compressed) lvliCompressed = true;
+                    else FormTableForEachLvliRef(payload, payloadSize, [&](std::uint32_t ref) { c.refs.push_back(ref); });
+                }
+                collected.push_back(std::move(c));
+            });
+
+        if (scan.isESL) rec.flags |= kFormTableModuleESL;
+
+        // build_form_maps skips worldspace modules: no entries, no IDs taken
+        if (scan.containsWorldspace) {
+            rec.flags |= kFormTableModuleWorldspace;
+            records.push_back(rec);
+            continue;
+        }
+
+        // Sorted by key, first record of a duplicated key kept (as the form map does)
+        const std::uint32_t keyMask = scan.isESL ? 0x00000FFFu : 0x00FFFFFFu;
+        for (auto& c : collected) c.key &= keyMask;
+        std::stable_sort(collected.begin(), collected.end(),
+            [](const Collected& a, const Collected& b) { return a.key < b.key; });
+        collected.erase(std::unique(collected.begin(), collected.end(),
+            [](const Collected& a, const Collected& b) { return a.key == b.key; }), collected.end());
+        if (lvliCompressed) rec.flags |= kFormTableModuleScanRecords;
+
+        const auto known = ledger.find(ToLower(name));
+        auto ledgered = [&](std::uint32_t key, std::uint32_t& target) {
+            if (known == ledger.end()) return false;
+            const auto it = known->second.find(key);
+            if (it == known->second.end() || it->second.first != dummy) return false;
+            target = (static_cast<std::uint32_t>(fileIndex) << 24) | it->second.second;
+            return true;
+        };
+
+        std::size_t fresh = 0;
+        std::uint32_t target = 0;
+        for (const auto& c : collected) {
+            if (!ledgered(c.key, target)) ++fresh;
+        }
+
+        targets.clear();
+        if (!ids.AllocateRun(fresh, targets)) return false;
+
+        std::size_t next = 0;
+        for (const auto& c : collected) {
+            if (!ledgered(c.key, target)) target = (static_cast<std::uint32_t>(fileIndex) << 24) | targets[next++];
+            const std::uint32_t refCount = lvliCompressed ? 0 : static_cast<std::uint32_t>(c.refs.size());
+            entries.push_back({ c.key, target, c.type, refCount });
+            if (refCount) refs.insert(refs.end(), c.refs.begin(), c.refs.end());
+        }
+
+        rec.entryCount = static_cast<std::uint32_t>(collected.size());
+        records.push_back(rec);
+    }
+
+    return true;
+}
+
+// ------------------------------------------------------------
+// Precomputed form maps (form_tables.bin)
+// Replays the plugin's build_form_maps offline, one table per CSV dummy
+// slot, so the runtime can skip scanning every plugin at startup. Slot
+// fileIndex and module routing follow the plugin's build_dummy_slots: row
+// order, first row wins, names not in slot.cfg are dropped. FormIDs the
+// plugin recorded in formid_ledger.bin are kept; the ledger is not written.
+// Format: Plugin/aSWMultiplexer/form_table_format.hpp
+// ------------------------------------------------------------
+bool WriteFormTables(const std::filesystem::path& tablePath,
+    const std::filesystem::path& dataPath,
+    std::uint8_t baseFileIndex,
+    const std::vector<ManifestRow>& rows,
+    const std::vector<std::string>& slotCfgModules,
+    std::ofstream& log)
+{
+    FormTableHeader header{};
+    std::memcpy(header.magic, kFormTableMagic, sizeof(header.magic));
+    header.version = kFormTableVersion;
+    header.headerSize = sizeof(FormTableHeader);
+
+    // Folded name -> slot.cfg spelling, for modules no earlier row has taken
+    std::unordered_map<std::string, std::string> unrouted;
+    for (const auto& m : slotCfgModules) unrouted.emplace(ToLower(m), m);
+
+    // The plugin keeps every FormID it has handed out; the tables must agree
+    const FormIdLedgerMap ledger = LoadFormIdLedger(tablePath.parent_path() / kFormIdLedgerFileName, log);
+
+    std::vector<FormTableSlot> slots;
+    std::vector<FormTableModule> records;
+    std::vector<FormTableEntry> entries;
+    std::vector<std::uint32_t> refs;
+    std::vector<char> names;
+
+    for (std::size_t k = 0; k < rows.size(); ++k) {
+        FormTableSlot slot{};
+        slot.fileIndex = DummySlotFileIndex(baseFileIndex, rows.size(), k);
+        slot.firstModule = static_cast<std::uint32_t>(records.size());
+
+        std::vector<std::string> modules;
+        for (const auto& m : rows[k].mods) {
+            auto it = unrouted.find(ToLower(m));
+            if (it == unrouted.end()) continue;
+            modules.push_back(it->second);
+            unrouted.erase(it);
+        }
+
+        const std::size_t recordMark = records.size(), entryMark = entries.size(), nameMark = names.size();
+        const std::size_t refMark = refs.size();
+        if (!WriteSlotFormTable(slot.fileIndex, rows[k].dummyName, modules, dataPath, ledger, records, entries, refs, names)) {
+            // The runtime moves overflowing plugins to another slot; leave this one to its scan
+            log << "FormTables: " << rows[k].dummyName << " does not fit in one dummy plugin; no table written for it.\n";
+            records.resize(recordMark);
+            entries.resize(entryMark);
+            refs.resize(refMark);
+            names.resize(nameMark);
+            continue;
+        }
+
+        slot.moduleCount = static_cast<std::uint32_t>(records.size()) - slot.firstModule;
+        slots.push_back(slot);
+    }
+
+    std::vector<std::uint8_t> out(sizeof(FormTableHeader), 0);
+
+    header.slotCount = static_cast<std::uint32_t>(slots.size());
+    header.slotOffset = BeginSection(out);
+    AppendBytes(out, slots.data(), slots.size() * sizeof(FormTableSlot));
+
+    header.moduleCount = static_cast<std::uint32_t>(records.size());
+    header.moduleOffset = BeginSection(out);
+    AppendBytes(out, records.data(), records.size() * sizeof(FormTableModule));
+
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.entryOffset = BeginSection(out);
+    AppendBytes(out, entries.data(), entries.size() * sizeof(FormTableEntry));
+
+    header.refCount = static_cast<std::uint32_t>(refs.size());
+    header.refOffset = BeginSection(out);
+    AppendBytes(out, refs.data(), refs.size() * sizeof(std::uint32_t));
+
+    header.nameBlobSize = static_cast<std::uint32_t>(names.size());
+    header.nameBlobOffset = BeginSection(out);
+    AppendBytes(out, names.data(), names.size());
+
+    header.fileSize = static_cast<std::uint32_t>(out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    header.checksum = FormTableChecksum(out.data(), out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    if (!ReplaceFileContents(tablePath, out, log))
+        return false;
+
+    log << "Form tables written: " << tablePath.string()
+        << " (" << slots.size() << " slots, " << records.size() << " modules, "
+        << entries.size() << " entries, " << refs.size() << " LVLI refs)\n";
+    return true;
+}
+
 // ------------------------------------------------------------
 // main
 // ------------------------------------------------------------
@@ -727,7 +1144,7 @@ int main() {
         }
 
         // Protected plugins: tracked but never multiplexed
-        bool isProtected = (protectedPlugins.count(lower) > 0);
+        bool isProtected = protectedPlugins.Matches(lower);
         if (isProtected && cfg.logDetails) {
             log << "PROTECTED: " << line << " is protected and will not be multiplexed.\n";
         }
@@ -942,6 +1359,7 @@ int main() {
     // Alias map: plugin -> dummy file
     std::map<std::string, std::string> aliasMap;
     std::unordered_set<std::string> usedDummyFiles;
+    std::vector<ManifestRow> manifestRows;
 
     auto assignCategoryGroup = [&](PluginCategory cat, const std::vector<std::string>& mods) {
         if (mods.empty()) return;
@@ -967,6 +1385,11 @@ int main() {
             const std::string& dummyName = slot->name;
             int virtualID = slot->virtualID;
 
+            ManifestRow row;
+            row.dummyName = dummyName;
+            row.virtualID = static_cast<std::uint32_t>(virtualID);
+            row.category = CategoryToString(cat);
+
             std::ostringstream modsList;
             bool first = true;
             int countInSlot = 0;
@@ -977,6 +1400,7 @@ int main() {
                 first = false;
 
                 modsList << CsvEscape(cleanName);
+                row.mods.push_back(cleanName);
 
                 auto it = aliasMap.find(cleanName);
                 if (it != aliasMap.end() && it->second != dummyName) {
@@ -997,6 +1421,7 @@ int main() {
                 << "\",\"" << virtualID
                 << "\",\"" << CategoryToString(cat)
                 << "\",\"" << modsList.str() << "\"\n";
+            manifestRows.push_back(std::move(row));
 
             if (cfg.logDetails) {
                 log << dummyName << " (VirtualID=" << virtualID
@@ -1082,6 +1507,29 @@ int main() {
 
     log << "DEBUG: Finished writing [Modules] section.\n";
 
+    outCSV.close();
+    outCfg.close();
+
+    //
+    // STEP 6b — Binary slot manifest + precomputed form maps (optional fast
+    // paths for the plugin)
+    //
+    {
+        std::vector<std::string> manifestModules;
+        for (const auto& p : includedPlugins) manifestModules.push_back(p.name);
+        for (const auto& p : worldspaceSkipped) manifestModules.push_back(p);
+
+        if (!WriteSlotManifest(pluginPath / kSlotManifestFileName, outputCSV, outputSlotCfg,
+                0xF0, manifestModules, manifestRows, aliasMap, log)) {
+            std::cerr << "WARNING: slot_manifest.bin not written; the plugin will read the CSV and slot.cfg.\n";
+        }
+
+        if (!WriteFormTables(pluginPath / kFormTableFileName, std::filesystem::path(falloutPath) / "Data",
+                0xF0, manifestRows, manifestModules, log)) {
+            std::cerr << "WARNING: form_tables.bin not written; the plugin will scan plugins at startup.\n";
+        }
+    }
+
     //
     // STEP 7 — Final validation
     //
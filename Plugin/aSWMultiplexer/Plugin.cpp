@@ -8,6 +8,10 @@
 #include "relocations.hpp"
 #include "identity.h"
 #include "diagnostics.h"
+#include "stage_tracer.hpp"
+#include "visibility.hpp"
+#include "name_resolver.hpp"
+#include "slot_manifest.hpp"
 
 #include <f4se/PluginAPI.h>
 #include "F4SE_Types.h"
@@ -38,6 +42,29 @@ F4SEInterface* g_f4se = nullptr;
 std::unordered_map<std::string, std::string> g_pluginAliasMap;
 bool g_consoleActive = false;
 
+// Live rewrite image: the injection context and the on-demand explainer
+// reference these for the whole session, so they must outlive F4SEPlugin_Load.
+static SlotDescriptor g_slot;                    // slot.cfg registry (every module)
+static std::vector<SlotDescriptor> g_dummySlots; // one per CSV dummy slot; the live rewrite image
+static std::vector<CSVSlot> g_csvSlots;
+static CSVSlotIndex g_csvIndex;
+
+// Closes the root span and writes the stage trace on every exit path of
+// F4SEPlugin_Load (stage spans are scoped inside it and close first).
+struct StageTraceSession
+{
+    std::uint64_t start = StageTrace_Now();
+
+    ~StageTraceSession()
+    {
+        if (!StageTrace_IsEnabled())
+            return;
+
+        StageTrace_Complete(TraceCat::Stage, "F4SEPlugin_Load", start, StageTrace_Now());
+        StageTrace_End("Data\\F4SE\\Plugins\\Multiplexer\\startup_trace.json");
+    }
+};
+
 // ============================================================================
 // Simple trampoline
 // ============================================================================
@@ -135,6 +162,14 @@ static void LoadAliasesFromSlotCfg()
 {
     g_pluginAliasMap.clear();
 
+    if (const SlotManifest* manifest = SlotManifest_Get()) {
+        manifest->ToAliasMap(g_pluginAliasMap);
+        logf("Alias loader: Loaded %zu alias mappings from %s.", g_pluginAliasMap.size(), kSlotManifestFileName);
+        if (g_consoleActive && !g_pluginAliasMap.empty())
+            CONSOLEF("[Aliases] Loaded " + std::to_string(g_pluginAliasMap.size()) + " alias mappings from the binary manifest.");
+        return;
+    }
+
     const std::string cfgPath = "Data\\F4SE\\Plugins\\Multiplexer\\slot.cfg";
 
     std::ifstream in(cfgPath);
@@ -199,22 +234,20 @@ static void LoadAliasesFromSlotCfg()
 // Redirection helpers
 // ============================================================================
 
-static const char* ResolvePluginAlias(const char* name)
+// One memo or table probe answers bypass / alias / passthrough without
+// allocating. Names match case-insensitively, as the engine treats plugin
+// file names.
+static void LogHookedResolution(const char* name, const PluginNameResolution& r, const char* hookName)
 {
-    if (!name)
-        return nullptr;
-
-    auto it = g_pluginAliasMap.find(name);
-    if (it == g_pluginAliasMap.end())
-        return name;
-
-    const std::string& mapped = it->second;
-
-    if (g_debugLogging)
-        logf("Alias: '%s' -> '%s'", name, mapped.c_str());
+    if (!g_debugLogging)
+        return;
 
-    return mapped.c_str();
+    if (r.action == PluginNameAction::Bypass)
+        logf("Identity: System-dependent plugin '%s' bypassed alias redirection in %s.", name, hookName);
+    else if (r.action == PluginNameAction::Alias)
+        logf("Alias: '%s' -> '%s'", name, r.target);
 }
+
 // ============================================================================
 // Hooks
 // ============================================================================
@@ -225,26 +258,28 @@ static LookupFormByID_t    s_originalLookupFormByID = nullptr;
 
 static void* Hook_LookupModByName(const char* name)
 {
-    if (IsSystemDependentCall(name)) {
-        if (g_debugLogging)
-            logf("Identity: System-dependent plugin '%s' bypassed alias redirection in LookupModByName.", name ? name : "<null>");
-        return s_originalLookupModByName(name);
-    }
+    const MemoizedNameLookup memo = NameMemo_Resolve(name, NameHookId::LookupModByName);
+    LogHookedResolution(name, memo.resolution, "LookupModByName");
+
+    if (memo.hasResult)
+        return reinterpret_cast<void*>(memo.result);
 
-    const char* aliased = ResolvePluginAlias(name);
-    return s_originalLookupModByName(aliased);
+    void* result = s_originalLookupModByName(memo.resolution.target);
+    NameMemo_StoreResult(name, NameHookId::LookupModByName, reinterpret_cast<std::uintptr_t>(result));
+    return result;
 }
 
 static UInt8 Hook_GetLoadedModIndex(const char* name)
 {
-    if (IsSystemDependentCall(name)) {
-        if (g_debugLogging)
-            logf("Identity: System-dependent plugin '%s' bypassed alias redirection in GetLoadedModIndex.", name ? name : "<null>");
-        return s_originalGetLoadedModIndex(name);
-    }
+    const MemoizedNameLookup memo = NameMemo_Resolve(name, NameHookId::GetLoadedModIndex);
+    LogHookedResolution(name, memo.resolution, "GetLoadedModIndex");
 
-    const char* aliased = ResolvePluginAlias(name);
-    return s_originalGetLoadedModIndex(aliased);
+    if (memo.hasResult)
+        return static_cast<UInt8>(memo.result);
+
+    const UInt8 result = s_originalGetLoadedModIndex(memo.resolution.target);
+    NameMemo_StoreResult(name, NameHookId::GetLoadedModIndex, result);
+    return result;
 }
 
 // NEW: Hook for FormID lookup — integrates the runtime injection subsystem.
@@ -308,6 +343,115 @@ static bool InstallRedirectionHooks()
     logf("Redirection hooks installed successfully.");
     return true;
 }
+// ============================================================================
+// F4SE messaging
+// ============================================================================
+
+static PluginHandle g_pluginHandle = kPluginHandle_Invalid;
+
+static std::uintptr_t QueryOriginalLookup(NameHookId hook, const char* target)
+{
+    switch (hook) {
+    case NameHookId::LookupModByName:
+        return reinterpret_cast<std::uintptr_t>(s_originalLookupModByName(target));
+    case NameHookId::GetLoadedModIndex:
+        return s_originalGetLoadedModIndex(target);
+    default:
+        return 0;
+    }
+}
+
+// Every plugin name this layer knows about: alias sources and targets,
+// system-dependent plugins, multiplexed modules and CSV slot plugins
+static std::vector<std::string> CollectKnownPluginNames()
+{
+    std::vector<std::string> names;
+
+    for (const auto& kv : g_pluginAliasMap) {
+        names.push_back(kv.first);
+        names.push_back(kv.second);
+    }
+    for (const auto& name : Identity_GetSystemDependentPlugins())
+        names.push_back(name);
+    for (const auto& mod : g_slot.modules)
+        names.push_back(mod.name);
+    for (const auto& csv : g_csvSlots) {
+        names.push_back(csv.dummyPlugin);
+        names.insert(names.end(), csv.sourceMods.begin(), csv.sourceMods.end());
+    }
+
+    return names;
+}
+
+// Post-load freeze: capture engine results so the hooks answer known names
+// without calling through
+static void FreezeNameLookups()
+{
+    if (!s_originalLookupModByName || !s_originalGetLoadedModIndex) {
+        logf("NameResolver: redirection hooks not installed — skipping load-order freeze.");
+        return;
+    }
+
+    NameResolver_FreezeLoadOrder(CollectKnownPluginNames(), &QueryOriginalLookup);
+}
+
+// Index the data handler loaded a plugin at (0xFF if not loaded). Asks the
+// data handler directly, so alias redirection does not apply.
+static std::uint8_t LoadedModIndex(const char* name)
+{
+    DataHandler* dataHandler = *g_dataHandler;
+    return dataHandler ? dataHandler->GetLoadedModIndex(name) : 0xFF;
+}
+
+// The dummy slots were laid out at load time assuming slot k loads at
+// base + k; now that the load order is real, drop any slot that did not
+// load there and publish the rewrite image from the rest.
+static void CheckDummySlotLoadOrder()
+{
+    if (g_dummySlots.empty())
+        return;
+
+    const std::size_t refused = refuse_misplaced_dummy_slots(g_dummySlots, &LoadedModIndex);
+
+    // Rewrites start here, with only the slots whose plugin loaded where
+    // the form maps expect it
+    InitInjectionContext(g_dummySlots, &g_csvIndex);
+    if (refused == 0)
+        return;
+
+    CONSOLEF("ERROR: " + std::to_string(refused) +
+        " dummy slot(s) refused: dummy plugin missing or out of load order (see Multiplexer.log).");
+}
+
+// GameDataReady carries a bool: true once data files are loaded, false when
+// they are being unloaded. Engine lookup results are only stable in between.
+static void OnF4SEMessage(F4SEMessagingInterface::Message* msg)
+{
+    if (!msg || msg->type != F4SEMessagingInterface::kMessage_GameDataReady)
+        return;
+
+    if (msg->data) {
+        FreezeNameLookups();
+        CheckDummySlotLoadOrder();
+    }
+    else
+        NameResolver_ThawLoadOrder();
+}
+
+static void RegisterMessagingListener(const F4SEInterface* f4se)
+{
+    g_pluginHandle = f4se->GetPluginHandle();
+
+    auto* messaging = static_cast<F4SEMessagingInterface*>(f4se->QueryInterface(kInterface_Messaging));
+    if (!messaging || !messaging->RegisterListener(g_pluginHandle, "F4SE", OnF4SEMessage)) {
+        logf("WARNING: F4SE messaging unavailable — hooked lookup results will not be frozen "
+            "and the dummy slots' load order cannot be checked, so no FormIDs will be rewritten.");
+        return;
+    }
+
+    logf("F4SE messaging listener registered.");
+}
+
 // ============================================================================
 // F4SE Plugin Query
 // ============================================================================
@@ -339,6 +483,8 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
 {
     g_f4se = const_cast<F4SEInterface*>(f4se);
 
+    StageTraceSession traceSession;
+
     //
     // ------------------------------------------------------------
     // NEW: Clear log immediately on plugin load
@@ -368,8 +514,15 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
     // Load configuration
     // ------------------------------------------------------------
     logf("Loading configuration...");
+    const std::uint64_t configStart = StageTrace_Now();
     LoadConfig();
 
+    // Tracing is configured by the INI, so the config stage is recorded after the fact
+    if (g_enableStageTrace) {
+        StageTrace_Begin();
+        StageTrace_Complete(TraceCat::Stage, "LoadConfig", configStart, StageTrace_Now());
+    }
+
     logf("Config loaded: Debug=%s, ScanOnStartup=%s, ESLDebug=%s, ShowConsole=%s",
         g_debugLogging ? "YES" : "NO",
         g_scanOnStartup ? "YES" : "NO",
@@ -377,6 +530,7 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
         g_showConsole ? "YES" : "NO");
 
     Identity_Initialize();
+    NameResolver_Rebuild(g_pluginAliasMap, Identity_GetSystemDependentPlugins());
     Diagnostics_Initialize();
 
     CONSOLEF("=== aSWMultiplexer Initialization ===");
@@ -398,6 +552,8 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
         CONSOLEF("Redirection hooks installed successfully.");
     }
 
+    RegisterMessagingListener(f4se);
+
     Diagnostics_RunValidator();
 
     if (!g_scanOnStartup) {
@@ -412,9 +568,19 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
     CONSOLEF("");
     CONSOLEF("[Step 1/4] Loading CSV dummy-slot mapping...");
 
-    std::vector<CSVSlot> csvSlots;
+    std::vector<CSVSlot>& csvSlots = g_csvSlots;
+    csvSlots.clear();
+
+    // Prefer csvbuilder's binary manifest; it also backs slot.cfg and the
+    // alias table below. Missing or stale manifests fall back to the text files.
+    SlotManifest_Load(g_csvPath);
 
-    if (!g_csvPath.empty()) {
+    if (const SlotManifest* manifest = SlotManifest_Get()) {
+        manifest->ToCsvSlots(csvSlots);
+        logf("Loaded %zu CSV dummy slot entries from %s.", csvSlots.size(), kSlotManifestFileName);
+        CONSOLEF("Loaded " + std::to_string(csvSlots.size()) + " CSV dummy slot entries (binary manifest).");
+    }
+    else if (!g_csvPath.empty()) {
         if (!load_csv_slots(g_csvPath, csvSlots)) {
             logf("ERROR: Failed to load CSV slots from '%s'", g_csvPath.c_str());
             CONSOLEF(std::string("ERROR: Failed to load CSV slots from '") + g_csvPath + "'.");
@@ -428,6 +594,20 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
         CONSOLEF("WARNING: No CSV path specified — skipping CSV slot mapping.");
     }
 
+    // Plugin -> row index used by injection and the rewrite explainer
+    g_csvIndex.Build(csvSlots);
+    for (const CSVSlotIndex::Duplicate& dup : g_csvIndex.Duplicates()) {
+        const std::string msg = "Plugin '" + dup.plugin + "' is listed in CSV rows " +
+            std::to_string(dup.firstRow + 1) + " (" + csvSlots[dup.firstRow].dummyPlugin + ") and " +
+            std::to_string(dup.repeatRow + 1) + " (" + csvSlots[dup.repeatRow].dummyPlugin + "); using row " +
+            std::to_string(dup.firstRow + 1) + ".";
+        logf("WARNING: %s", msg.c_str());
+        Diagnostics_RecordMappingIssue(msg);
+    }
+    if (!g_csvIndex.Duplicates().empty())
+        CONSOLEF("WARNING: " + std::to_string(g_csvIndex.Duplicates().size()) +
+            " plugin(s) listed in more than one CSV row (see Multiplexer.log).");
+
     //
     // ------------------------------------------------------------
     // Slot configuration
@@ -435,7 +615,8 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
     CONSOLEF("");
     CONSOLEF("[Step 2/4] Loading slot configuration...");
 
-    SlotDescriptor slot{};
+    SlotDescriptor& slot = g_slot;
+    slot = SlotDescriptor{};
     if (!load_slot_config(slot)) {
         logf("ERROR: Failed to load slot configuration.");
         CONSOLEF("ERROR: Failed to load slot configuration.");
@@ -452,6 +633,7 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
     CONSOLEF("");
     CONSOLEF("[Aliases] Loading plugin alias mappings from slot.cfg...");
     LoadAliasesFromSlotCfg();
+    NameResolver_Rebuild(g_pluginAliasMap, Identity_GetSystemDependentPlugins());
 
     Diagnostics_RunValidator();
 
@@ -462,55 +644,52 @@ bool F4SEPlugin_Load(const F4SEInterface* f4se)
     CONSOLEF("");
     CONSOLEF("[Step 3/4] Scanning module metadata (ESL, FE slots, etc.)...");
 
-    for (auto& m : slot.modules) {
-        if (!scan_plugin_metadata(m.name, m)) {
-            logf("WARNING: Failed to scan metadata for module '%s'", m.name.c_str());
-            CONSOLEF(std::string("WARNING: Failed to scan metadata for module '") + m.name + "'.");
-        }
-        else if (g_eslDebug) {
-            logf("Module '%s': ESL=%s, eslSlot=%u",
-                m.name.c_str(),
-                m.isESL ? "YES" : "NO",
-                m.eslSlot);
-
-            CONSOLEF(std::string("Module '") + m.name +
-                "': ESL=" + (m.isESL ? "YES" : "NO") +
-                ", eslSlot=" + std::to_string(m.eslSlot));
+    {
+        StageTraceSpan stageSpan(TraceCat::Stage, "scan_plugin_metadata");
+        for (auto& m : slot.modules) {
+            StageTraceSpan moduleSpan(TraceCat::Module, m.name);
+            if (!scan_plugin_metadata(m.name, m)) {
+                logf("WARNING: Failed to scan metadata for module '%s'", m.name.c_str());
+                CONSOLEF(std::string("WARNING: Failed to scan metadata for module '") + m.name + "'.");
+            }
+            else if (g_eslDebug) {
+                logf("Module '%s': ESL=%s, eslSlot=%u",
+                    m.name.c_str(),
+                    m.isESL ? "YES" : "NO",
+                    m.eslSlot);
+
+                CONSOLEF(std::string("Module '") + m.name +
+                    "': ESL=" + (m.isESL ? "YES" : "NO") +
+                    ", eslSlot=" + std::to_string(m.eslSlot));
+            }
         }
     }
 
     //
     // ------------------------------------------------------------
-    // Build form maps
+    // Dummy slots: form maps + injection, all slots in parallel
     // ------------------------------------------------------------
     CONSOLEF("");
-    CONSOLEF("[Step 4/4] Building form ID maps...");
+    CONSOLEF("[Step 4/4] Building form ID maps and injecting records for each dummy slot...");
 
-    if (!build_form_maps(slot)) {
-        logf("ERROR: Failed to build form maps.");
-        CONSOLEF("ERROR: Failed to build form maps.");
+    build_dummy_slots(slot, g_csvIndex, g_dummySlots);
+    CONSOLEF("Routing " + std::to_string(slot.modules.size()) + " modules into " +
+        std::to_string(g_dummySlots.size()) + " dummy slots.");
+
+    if (!process_dummy_slots(slot, g_dummySlots, g_csvIndex)) {
+        logf("ERROR: Dummy slot processing failed.");
+        CONSOLEF("ERROR: Dummy slot processing failed.");
         return false;
     }
 
-    CONSOLEF("Form ID maps built successfully.");
+    // The rewrite image is published on GameDataReady, once the dummy
+    // plugins' load-order indices have been checked (CheckDummySlotLoadOrder)
 
-    // ------------------------------------------------------------
-    // NEW: Initialize runtime injection context for FormID rewrite
-    // ------------------------------------------------------------
-    InitInjectionContext(slot, slot.modules);
-
-    //
-    // ------------------------------------------------------------
-    // Inject records
-    // ------------------------------------------------------------
-    CONSOLEF("");
-    CONSOLEF("[Final] Injecting records using CSV slot mapping...");
+    // Visibility snapshot: built from scanner stats, logged as a diff by default
+    PublishVisibilitySnapshot(BuildVisibilitySnapshot(slot, slot.modules));
 
-    if (!inject_records(slot, csvSlots)) {
-        logf("ERROR: Record injection failed.");
-        CONSOLEF("ERROR: Record injection failed.");
-        return false;
-    }
+    // Diagnostics report is written in the background
+    Diagnostics_Finalize();
 
     logf("aSWMultiplexer initialization complete.");
     CONSOLEF("Record injection completed successfully.");
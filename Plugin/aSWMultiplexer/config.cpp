@@ -1,10 +1,16 @@
 #include "pch.h"
 #include "config.hpp"
 #include "log.hpp"
+#include "glob_matcher.hpp"
 
 #include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <mutex>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <vector>
@@ -18,120 +24,328 @@ bool g_eslDebug = false;
 bool g_showConsole = false;
 bool g_enableRuntimeRewrite = true;
 bool g_writeSkippedModules = true;
+bool g_enableStageTrace = false;
+int g_visibilityLogMode = 1;
 
 std::string g_targetModule;
 std::string g_csvPath;
+std::string g_diagnosticsFormat = "text";
 
 // ------------------------------------------------------------
-// Protected plugin whitelist storage
+// Protected plugin whitelist storage (exact names and globs,
+// compiled into one case-insensitive DFA)
 // ------------------------------------------------------------
-static std::unordered_set<std::string> g_protectedPlugins;
+static GlobMatcher g_protectedPlugins;
 
 // Forward declaration
 void LoadProtectedPluginWhitelist();
 
 // ------------------------------------------------------------
-// LoadConfig() - reads multiplexer.ini
+// Snapshot and change listeners
 // ------------------------------------------------------------
-void LoadConfig()
+static std::mutex g_configMutex;
+static std::shared_ptr<const MultiplexerConfig> g_configSnapshot =
+    std::make_shared<const MultiplexerConfig>();
+
+static std::vector<std::pair<std::size_t, ConfigChangeListener>> g_configListeners;
+static std::size_t g_nextListenerToken = 1;
+
+std::shared_ptr<const MultiplexerConfig> Config_GetSnapshot()
 {
-    const std::string iniPath = "Data\\F4SE\\Plugins\\Multiplexer\\multiplexer.ini";
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    return g_configSnapshot;
+}
 
-    // Read booleans
-    g_debugLogging = GetPrivateProfileIntA("General", "bEnableDebugLogging", 0, iniPath.c_str()) != 0;
-    g_scanOnStartup = GetPrivateProfileIntA("General", "bScanOnStartup", 1, iniPath.c_str()) != 0;
-    g_eslDebug = GetPrivateProfileIntA("General", "bEnableESLDebug", 0, iniPath.c_str()) != 0;
-    g_showConsole = GetPrivateProfileIntA("General", "bShowConsole", 0, iniPath.c_str()) != 0;
+std::size_t Config_Subscribe(ConfigChangeListener listener)
+{
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    const std::size_t token = g_nextListenerToken++;
+    g_configListeners.emplace_back(token, std::move(listener));
+    return token;
+}
 
-    g_enableRuntimeRewrite =
-        GetPrivateProfileIntA("General", "bEnableRuntimeRewrite", 1, iniPath.c_str()) != 0;
+void Config_Unsubscribe(std::size_t token)
+{
+    std::lock_guard<std::mutex> lock(g_configMutex);
+    g_configListeners.erase(
+        std::remove_if(g_configListeners.begin(), g_configListeners.end(),
+            [token](const auto& entry) { return entry.first == token; }),
+        g_configListeners.end());
+}
 
-    g_writeSkippedModules =
-        GetPrivateProfileIntA("General", "bWriteSkippedModules", 1, iniPath.c_str()) != 0;
+// ------------------------------------------------------------
+// INI parsing
+//
+// Matches the GetPrivateProfile* rules the plugin used before:
+// section and key names are case-insensitive, ';' / '#' start a
+// comment line, values are trimmed and one pair of surrounding
+// quotes is removed, the first occurrence of a key wins.
+// ------------------------------------------------------------
+using IniSection = std::unordered_map<std::string, std::string>;
+using IniDocument = std::unordered_map<std::string, IniSection>;
 
-    // Read strings
-    char buf[512] = {};
+static std::string LowerAscii(std::string s)
+{
+    for (char& c : s)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
 
-    GetPrivateProfileStringA("General", "sTargetModule", "", buf, sizeof(buf), iniPath.c_str());
-    g_targetModule = buf;
+static void TrimInPlace(std::string& s)
+{
+    auto notSpace = [](unsigned char c) { return !std::isspace(c); };
+    s.erase(s.begin(), std::find_if(s.begin(), s.end(), notSpace));
+    s.erase(std::find_if(s.rbegin(), s.rend(), notSpace).base(), s.end());
+}
 
-    GetPrivateProfileStringA("General", "sCSVPath", "", buf, sizeof(buf), iniPath.c_str());
-    g_csvPath = buf;
+static bool ReadIniDocument(const std::string& path, IniDocument& out)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
 
-    // Idiot-proofing: If CSV path is empty, auto-fill default
-    if (g_csvPath.empty()) {
-        g_csvPath = "Data\\F4SE\\Plugins\\Multiplexer\\loadorder_mapped_filtered_clean.csv";
-        logf("No CSV path specified in INI - using default: %s", g_csvPath.c_str());
-    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
 
-    // Log final configuration
-    logf("Config loaded: Debug=%s, ScanOnStartup=%s, ESLDebug=%s, ShowConsole=%s, RuntimeRewrite=%s",
-        g_debugLogging ? "YES" : "NO",
-        g_scanOnStartup ? "YES" : "NO",
-        g_eslDebug ? "YES" : "NO",
-        g_showConsole ? "YES" : "NO",
-        g_enableRuntimeRewrite ? "YES" : "NO");
+    // UTF-8 BOM
+    if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        text.erase(0, 3);
 
-    logf("Configuration loaded:");
-    logf("  Debug Logging: %s", g_debugLogging ? "ENABLED" : "DISABLED");
-    logf("  ESL Debug: %s", g_eslDebug ? "ENABLED" : "DISABLED");
-    logf("  Scan On Startup: %s", g_scanOnStartup ? "YES" : "NO");
-    logf("  Target Module: '%s'", g_targetModule.empty() ? "<none>" : g_targetModule.c_str());
-    logf("  CSV Path: '%s'", g_csvPath.c_str());
-    logf("  Runtime Rewrite: %s", g_enableRuntimeRewrite ? "ENABLED" : "DISABLED");
-    logf("  Write Skipped Modules: %s", g_writeSkippedModules ? "ENABLED" : "DISABLED");
+    IniSection* section = nullptr;
+    std::istringstream lines(text);
+    std::string line;
 
-    // Load protected plugin whitelist
-    LoadProtectedPluginWhitelist();
+    while (std::getline(lines, line))
+    {
+        TrimInPlace(line);
+        if (line.empty() || line[0] == ';' || line[0] == '#')
+            continue;
+
+        if (line[0] == '[') {
+            const std::size_t close = line.find(']');
+            std::string name = line.substr(1, close == std::string::npos ? std::string::npos : close - 1);
+            TrimInPlace(name);
+            section = &out[LowerAscii(name)];
+            continue;
+        }
+
+        if (!section)
+            continue;
+
+        const std::size_t eq = line.find('=');
+        if (eq == std::string::npos)
+            continue;
+
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        TrimInPlace(key);
+        TrimInPlace(value);
+
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+            value = value.substr(1, value.size() - 2);
+
+        if (!key.empty())
+            section->emplace(LowerAscii(key), std::move(value));
+    }
+
+    return true;
 }
 
 // ------------------------------------------------------------
-// Minimal JSON parser for protected_plugins.json
+// Schema
+//
+// One row per INI key. Ints outside [minValue, maxValue] fall
+// back to the field's default with a log line.
 // ------------------------------------------------------------
+struct ConfigKey
+{
+    enum class Kind { Bool, Int, String };
+
+    const char* section;
+    const char* name;
+    Kind kind;
+    bool MultiplexerConfig::* boolField;
+    int MultiplexerConfig::* intField;
+    std::string MultiplexerConfig::* stringField;
+    int minValue;
+    int maxValue;
+};
+
+static ConfigKey BoolKey(const char* name, bool MultiplexerConfig::* field)
+{
+    return { "General", name, ConfigKey::Kind::Bool, field, nullptr, nullptr, 0, 0 };
+}
 
-static std::string ReadFileToString(const std::string& path)
+static ConfigKey IntKey(const char* name, int MultiplexerConfig::* field, int minValue, int maxValue)
 {
-    std::ifstream file(path);
-    if (!file.is_open())
-        return "";
+    return { "General", name, ConfigKey::Kind::Int, nullptr, field, nullptr, minValue, maxValue };
+}
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+static ConfigKey StringKey(const char* name, std::string MultiplexerConfig::* field)
+{
+    return { "General", name, ConfigKey::Kind::String, nullptr, nullptr, field, 0, 0 };
 }
 
-static std::vector<std::string> ExtractJsonKeys(const std::string& json)
+static const std::vector<ConfigKey>& ConfigSchema()
 {
-    std::vector<std::string> keys;
+    static const std::vector<ConfigKey> schema = {
+        BoolKey("bEnableDebugLogging", &MultiplexerConfig::debugLogging),
+        BoolKey("bScanOnStartup", &MultiplexerConfig::scanOnStartup),
+        BoolKey("bEnableESLDebug", &MultiplexerConfig::eslDebug),
+        BoolKey("bShowConsole", &MultiplexerConfig::showConsole),
+        BoolKey("bEnableRuntimeRewrite", &MultiplexerConfig::enableRuntimeRewrite),
+        BoolKey("bWriteSkippedModules", &MultiplexerConfig::writeSkippedModules),
+        BoolKey("bEnableStageTrace", &MultiplexerConfig::enableStageTrace),
+        IntKey("iVisibilityLogMode", &MultiplexerConfig::visibilityLogMode, 0, 2),
+        StringKey("sTargetModule", &MultiplexerConfig::targetModule),
+        StringKey("sCSVPath", &MultiplexerConfig::csvPath),
+        StringKey("sDiagnosticsFormat", &MultiplexerConfig::diagnosticsFormat),
+    };
+    return schema;
+}
 
-    size_t pos = 0;
-    while (true)
+// Leading integer, as GetPrivateProfileIntA parses it (non-numeric = 0)
+static int ParseIniInt(const std::string& value)
+{
+    return static_cast<int>(std::strtol(value.c_str(), nullptr, 10));
+}
+
+static MultiplexerConfig ApplySchema(const IniDocument& doc)
+{
+    MultiplexerConfig cfg;
+
+    for (const ConfigKey& key : ConfigSchema())
     {
-        size_t start = json.find('"', pos);
-        if (start == std::string::npos)
+        const auto sec = doc.find(LowerAscii(key.section));
+        if (sec == doc.end())
+            continue;
+
+        const auto it = sec->second.find(LowerAscii(key.name));
+        if (it == sec->second.end())
+            continue;
+
+        const std::string& value = it->second;
+
+        switch (key.kind)
+        {
+        case ConfigKey::Kind::Bool:
+            cfg.*key.boolField = ParseIniInt(value) != 0;
             break;
 
-        size_t end = json.find('"', start + 1);
-        if (end == std::string::npos)
+        case ConfigKey::Kind::Int: {
+            const int v = ParseIniInt(value);
+            if (v < key.minValue || v > key.maxValue) {
+                logf("%s=%d out of range (%d-%d) - using %d.",
+                    key.name, v, key.minValue, key.maxValue, cfg.*key.intField);
+                break;
+            }
+            cfg.*key.intField = v;
             break;
+        }
 
-        std::string key = json.substr(start + 1, end - start - 1);
-        pos = end + 1;
+        case ConfigKey::Kind::String:
+            cfg.*key.stringField = value;
+            break;
+        }
+    }
 
-        if (key == "_comment")
-            continue;
+    if (cfg.diagnosticsFormat.empty())
+        cfg.diagnosticsFormat = "text";
 
-        if (key.empty())
-            continue;
+    // Idiot-proofing: If CSV path is empty, auto-fill default
+    if (cfg.csvPath.empty()) {
+        cfg.csvPath = "Data\\F4SE\\Plugins\\Multiplexer\\loadorder_mapped_filtered_clean.csv";
+        logf("No CSV path specified in INI - using default: %s", cfg.csvPath.c_str());
+    }
 
-        if (key == "protected" || key == "injectable" || key == "reason")
-            continue;
+    return cfg;
+}
+
+static bool SameConfig(const MultiplexerConfig& a, const MultiplexerConfig& b)
+{
+    return a.debugLogging == b.debugLogging &&
+        a.scanOnStartup == b.scanOnStartup &&
+        a.eslDebug == b.eslDebug &&
+        a.showConsole == b.showConsole &&
+        a.enableRuntimeRewrite == b.enableRuntimeRewrite &&
+        a.writeSkippedModules == b.writeSkippedModules &&
+        a.enableStageTrace == b.enableStageTrace &&
+        a.visibilityLogMode == b.visibilityLogMode &&
+        a.targetModule == b.targetModule &&
+        a.csvPath == b.csvPath &&
+        a.diagnosticsFormat == b.diagnosticsFormat;
+}
+
+static void MirrorToGlobals(const MultiplexerConfig& cfg)
+{
+    g_debugLogging = cfg.debugLogging;
+    g_scanOnStartup = cfg.scanOnStartup;
+    g_eslDebug = cfg.eslDebug;
+    g_showConsole = cfg.showConsole;
+    g_enableRuntimeRewrite = cfg.enableRuntimeRewrite;
+    g_writeSkippedModules = cfg.writeSkippedModules;
+    g_enableStageTrace = cfg.enableStageTrace;
+    g_visibilityLogMode = cfg.visibilityLogMode;
+    g_targetModule = cfg.targetModule;
+    g_csvPath = cfg.csvPath;
+    g_diagnosticsFormat = cfg.diagnosticsFormat;
+}
+
+// ------------------------------------------------------------
+// LoadConfig() - reads multiplexer.ini
+// ------------------------------------------------------------
+void LoadConfig()
+{
+    const std::string iniPath = "Data\\F4SE\\Plugins\\Multiplexer\\multiplexer.ini";
+
+    // One read of the file; every key comes from the parsed document
+    IniDocument doc;
+    if (!ReadIniDocument(iniPath, doc))
+        logf("multiplexer.ini not found at '%s' - using defaults.", iniPath.c_str());
 
-        if (key.find('.') != std::string::npos)
-            keys.push_back(key);
+    auto next = std::make_shared<const MultiplexerConfig>(ApplySchema(doc));
+
+    std::shared_ptr<const MultiplexerConfig> previous;
+    std::vector<ConfigChangeListener> listeners;
+    {
+        std::lock_guard<std::mutex> lock(g_configMutex);
+        previous = g_configSnapshot;
+        g_configSnapshot = next;
+        for (const auto& entry : g_configListeners)
+            listeners.push_back(entry.second);
     }
 
-    return keys;
+    MirrorToGlobals(*next);
+
+    // Log final configuration
+    logf("Config loaded: Debug=%s, ScanOnStartup=%s, ESLDebug=%s, ShowConsole=%s, RuntimeRewrite=%s",
+        g_debugLogging ? "YES" : "NO",
+        g_scanOnStartup ? "YES" : "NO",
+        g_eslDebug ? "YES" : "NO",
+        g_showConsole ? "YES" : "NO",
+        g_enableRuntimeRewrite ? "YES" : "NO");
+
+    logf("Configuration loaded:");
+    logf("  Debug Logging: %s", g_debugLogging ? "ENABLED" : "DISABLED");
+    logf("  ESL Debug: %s", g_eslDebug ? "ENABLED" : "DISABLED");
+    logf("  Scan On Startup: %s", g_scanOnStartup ? "YES" : "NO");
+    logf("  Target Module: '%s'", g_targetModule.empty() ? "<none>" : g_targetModule.c_str());
+    logf("  CSV Path: '%s'", g_csvPath.c_str());
+    logf("  Diagnostics Format: '%s'", g_diagnosticsFormat.c_str());
+    logf("  Stage Trace: %s", g_enableStageTrace ? "ENABLED" : "DISABLED");
+    logf("  Visibility Log Mode: %d", g_visibilityLogMode);
+    logf("  Runtime Rewrite: %s", g_enableRuntimeRewrite ? "ENABLED" : "DISABLED");
+    logf("  Write Skipped Modules: %s", g_writeSkippedModules ? "ENABLED" : "DISABLED");
+
+    // Listeners run outside the lock so they may read the snapshot
+    if (!SameConfig(*previous, *next)) {
+        for (const auto& listener : listeners)
+            listener(*previous, *next);
+    }
+
+    // Load protected plugin whitelist
+    LoadProtectedPluginWhitelist();
 }
 
 // ------------------------------------------------------------
@@ -144,20 +358,32 @@ void LoadProtectedPluginWhitelist()
 
     logf("Loading protected plugin whitelist from: %s", path.c_str());
 
-    std::string json = ReadFileToString(path);
-    if (json.empty())
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
     {
         logf("WARNING: Could not read protected_plugins.json or file is empty.");
         return;
     }
 
-    std::vector<std::string> keys = ExtractJsonKeys(json);
+    std::vector<std::string> patterns;
+    std::string error;
+    if (!ReadWhitelistPatterns(file, patterns, error))
+    {
+        logf("WARNING: protected_plugins.json is malformed (%s) - whitelist not changed.", error.c_str());
+        return;
+    }
+
+    GlobMatcher matcher;
+    for (const std::string& pattern : patterns)
+        matcher.Add(pattern);
+    if (!matcher.Build())
+        logf("GlobMatcher: %zu patterns exceed %zu DFA states - matching patterns one by one.",
+            matcher.PatternCount(), GlobMatcher::kMaxStates);
 
-    g_protectedPlugins.clear();
-    for (std::size_t i = 0; i < keys.size(); ++i)
-        g_protectedPlugins.insert(keys[i]);
+    g_protectedPlugins = std::move(matcher);
 
-    logf("Protected plugin whitelist loaded: %zu entries", g_protectedPlugins.size());
+    logf("Protected plugin whitelist loaded: %zu entries (%zu matcher states)",
+        g_protectedPlugins.PatternCount(), g_protectedPlugins.StateCount());
 }
 
 // ------------------------------------------------------------
@@ -165,5 +391,5 @@ void LoadProtectedPluginWhitelist()
 // ------------------------------------------------------------
 bool IsPluginProtected(const std::string& pluginName)
 {
-    return g_protectedPlugins.find(pluginName) != g_protectedPlugins.end();
+    return g_protectedPlugins.Matches(pluginName);
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
 
 // ------------------------------------------------------------
@@ -22,6 +25,50 @@ extern bool g_enableRuntimeRewrite;
 // Write SkippedModules.txt toggle
 extern bool g_writeSkippedModules;
 
+// Write startup_trace.json (Chrome trace-event format) toggle
+extern bool g_enableStageTrace;
+
+// Visibility snapshot logging: 0 = off, 1 = diff vs previous launch, 2 = full dump
+extern int g_visibilityLogMode;
+
+// Diagnostics report format: "text", "jsonl" or "both"
+extern std::string g_diagnosticsFormat;
+
+// ------------------------------------------------------------
+// Typed configuration snapshot
+//
+// multiplexer.ini is read once per LoadConfig into this struct
+// (defaults below apply to missing keys). The globals above are
+// mirrors of the current snapshot, kept for existing callers.
+// ------------------------------------------------------------
+struct MultiplexerConfig
+{
+    bool debugLogging = false;          // bEnableDebugLogging
+    bool scanOnStartup = true;          // bScanOnStartup
+    bool eslDebug = false;              // bEnableESLDebug
+    bool showConsole = false;           // bShowConsole
+    bool enableRuntimeRewrite = true;   // bEnableRuntimeRewrite
+    bool writeSkippedModules = true;    // bWriteSkippedModules
+    bool enableStageTrace = false;      // bEnableStageTrace
+    int visibilityLogMode = 1;          // iVisibilityLogMode (0-2)
+
+    std::string targetModule;           // sTargetModule
+    std::string csvPath;                // sCSVPath (empty = default path)
+    std::string diagnosticsFormat = "text";  // sDiagnosticsFormat
+};
+
+// Current snapshot; never null (defaults before the first LoadConfig)
+std::shared_ptr<const MultiplexerConfig> Config_GetSnapshot();
+
+// Called after LoadConfig publishes a snapshot that differs from the
+// previous one. Runs on the thread that called LoadConfig.
+using ConfigChangeListener =
+    std::function<void(const MultiplexerConfig& previous, const MultiplexerConfig& current)>;
+
+// Returns a token for Config_Unsubscribe
+std::size_t Config_Subscribe(ConfigChangeListener listener);
+void Config_Unsubscribe(std::size_t token);
+
 // ------------------------------------------------------------
 // Load configuration from INI
 // ------------------------------------------------------------
@@ -1,54 +1,250 @@
 #include "pch.h"
 #include "csv.hpp"
+#include "mapped_file.hpp"
 
-#include <fstream>
-#include <sstream>
-#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdint>
 
-// Read a CSV file into a vector of rows (map column -> value)
-std::vector<std::unordered_map<std::string, std::string>> read_csv(const std::string& path)
+// ============================================================================
+// CsvReader
+// ============================================================================
+
+std::string CsvField::Value() const
 {
-    std::ifstream file(path);
-    std::vector<std::unordered_map<std::string, std::string>> rows;
+    if (!hasEscapes)
+        return std::string(text);
 
-    if (!file.is_open()) {
-        return rows; // return empty if file can't be opened
+    std::string out;
+    out.reserve(text.size());
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        out.push_back(text[i]);
+        if (text[i] == '"' && i + 1 < text.size() && text[i + 1] == '"')
+            ++i;
     }
+    return out;
+}
 
-    std::string headerLine;
-    if (!std::getline(file, headerLine)) {
-        return rows; // no header line
+CsvReader::CsvReader(const char* data, std::size_t size)
+    : m_pos(data), m_end(data + size)
+{
+    if (size >= 3 &&
+        static_cast<unsigned char>(data[0]) == 0xEF &&
+        static_cast<unsigned char>(data[1]) == 0xBB &&
+        static_cast<unsigned char>(data[2]) == 0xBF)
+    {
+        m_pos += 3;
     }
+}
+
+bool CsvReader::NextRecord(std::vector<CsvField>& fields)
+{
+    fields.clear();
+    m_malformed = false;
 
-    // Parse header columns
-    std::vector<std::string> headers;
+    // Skip blank lines
+    while (m_pos < m_end && (*m_pos == '\n' || *m_pos == '\r')) {
+        if (*m_pos == '\n')
+            ++m_line;
+        ++m_pos;
+    }
+
+    if (m_pos >= m_end)
+        return false;
+
+    m_recordLine = m_line;
+
+    for (;;)
     {
-        std::stringstream ss(headerLine);
-        std::string col;
-        while (std::getline(ss, col, ',')) {
-            headers.push_back(trim(col));   // trim comes from utils.cpp
+        CsvField field;
+
+        if (m_pos < m_end && *m_pos == '"')
+        {
+            const char* start = ++m_pos;
+            for (;;)
+            {
+                if (m_pos >= m_end) {
+                    // Unterminated quote: take the rest of the input
+                    m_malformed = true;
+                    field.text = std::string_view(start, static_cast<std::size_t>(m_end - start));
+                    break;
+                }
+                if (*m_pos == '"') {
+                    if (m_pos + 1 < m_end && m_pos[1] == '"') {
+                        field.hasEscapes = true;
+                        m_pos += 2;
+                        continue;
+                    }
+                    field.text = std::string_view(start, static_cast<std::size_t>(m_pos - start));
+                    ++m_pos;
+                    break;
+                }
+                if (*m_pos == '\n')
+                    ++m_line;
+                ++m_pos;
+            }
+
+            // Anything between the closing quote and the delimiter is dropped
+            while (m_pos < m_end && *m_pos != ',' && *m_pos != '\n' && *m_pos != '\r') {
+                if (*m_pos != ' ' && *m_pos != '\t')
+                    m_malformed = true;
+                ++m_pos;
+            }
         }
+        else
+        {
+            const char* start = m_pos;
+            while (m_pos < m_end && *m_pos != ',' && *m_pos != '\n' && *m_pos != '\r')
+                ++m_pos;
+            field.text = std::string_view(start, static_cast<std::size_t>(m_pos - start));
+        }
+
+        fields.push_back(field);
+
+        if (m_pos < m_end && *m_pos == ',') {
+            ++m_pos;
+            continue;
+        }
+
+        // End of record: consume one LF, CRLF or lone CR
+        if (m_pos < m_end && *m_pos == '\r')
+            ++m_pos;
+        if (m_pos < m_end && *m_pos == '\n') {
+            ++m_pos;
+            ++m_line;
+        }
+        return true;
     }
+}
+
+std::string_view trim_view(std::string_view s)
+{
+    const char* whitespace = " \t\n\r\f\v";
+
+    const std::size_t start = s.find_first_not_of(whitespace);
+    if (start == std::string_view::npos)
+        return {};
+
+    const std::size_t end = s.find_last_not_of(whitespace);
+    return s.substr(start, end - start + 1);
+}
+
+// ============================================================================
+// CsvTable
+// ============================================================================
+
+bool CsvTable::Load(const std::string& path)
+{
+    m_headers.clear();
+    m_columns.clear();
+    m_rows.clear();
+    m_unescaped.clear();
+    m_rowCount = 0;
 
-    // Parse each subsequent line
-    std::string line;
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string value;
-        std::unordered_map<std::string, std::string> row;
-        size_t colIndex = 0;
+    if (!m_file.Open(path))
+        return false;
 
-        while (std::getline(ss, value, ',')) {
-            if (colIndex < headers.size()) {
-                row[headers[colIndex]] = trim(value);   // trim comes from utils.cpp
+    CsvReader reader(reinterpret_cast<const char*>(m_file.Data()), m_file.Size());
+    std::vector<CsvField> fields;
+
+    if (!reader.NextRecord(fields))
+        return true;    // empty file: no columns, no rows
+
+    m_headers.reserve(fields.size());
+    for (const CsvField& f : fields)
+        m_headers.push_back(trim(f.Value()));
+
+    // Size the columns from a cheap line count (an upper bound for rows)
+    std::size_t lines = 0;
+    for (std::size_t i = 0; i < m_file.Size(); ++i)
+        lines += m_file.Data()[i] == '\n';
+
+    m_columns.resize(m_headers.size());
+    for (auto& column : m_columns)
+        column.reserve(lines + 1);
+    m_rows.reserve(lines + 1);
+
+    // Escaped cells are appended to m_unescaped, which may reallocate, so
+    // their views are patched once parsing is done
+    struct Fixup { std::size_t col, row, offset, length; };
+    std::vector<Fixup> fixups;
+
+    while (reader.NextRecord(fields))
+    {
+        m_rows.push_back(RowInfo{ reader.LineNumber(), fields.size(), reader.Malformed() });
+
+        for (std::size_t col = 0; col < m_columns.size(); ++col)
+        {
+            if (col >= fields.size()) {
+                m_columns[col].emplace_back();
+                continue;
+            }
+
+            const CsvField& f = fields[col];
+            if (!f.hasEscapes) {
+                m_columns[col].push_back(trim_view(f.text));
+                continue;
             }
-            ++colIndex;
-        }
 
-        if (!row.empty()) {
-            rows.push_back(std::move(row));
+            const std::string value = f.Value();
+            const std::string_view trimmed = trim_view(value);
+            fixups.push_back({ col, m_rowCount, m_unescaped.size(), trimmed.size() });
+            m_unescaped.insert(m_unescaped.end(), trimmed.begin(), trimmed.end());
+            m_columns[col].emplace_back();
         }
+        ++m_rowCount;
+    }
+
+    for (const Fixup& f : fixups)
+        m_columns[f.col][f.row] = std::string_view(m_unescaped.data() + f.offset, f.length);
+
+    return true;
+}
+
+std::size_t CsvTable::ColumnIndex(std::string_view name) const
+{
+    for (std::size_t i = 0; i < m_headers.size(); ++i) {
+        const std::string& h = m_headers[i];
+        if (h.size() == name.size() && _strnicmp(h.data(), name.data(), name.size()) == 0)
+            return i;
+    }
+    return npos;
+}
+
+bool CsvTable::GetInt64(std::size_t row, std::size_t col, std::int64_t& out) const
+{
+    std::string_view v = Get(row, col);
+
+    bool negative = false;
+    if (!v.empty() && (v[0] == '-' || v[0] == '+')) {
+        negative = v[0] == '-';
+        v.remove_prefix(1);
     }
 
-    return rows;
+    int base = 10;
+    if (v.size() > 2 && v[0] == '0' && (v[1] == 'x' || v[1] == 'X')) {
+        base = 16;
+        v.remove_prefix(2);
+    }
+
+    std::uint64_t magnitude = 0;
+    const auto r = std::from_chars(v.data(), v.data() + v.size(), magnitude, base);
+    if (v.empty() || r.ec != std::errc() || r.ptr != v.data() + v.size())
+        return false;
+
+    if (magnitude > static_cast<std::uint64_t>(INT64_MAX) + (negative ? 1u : 0u))
+        return false;
+
+    out = negative ? static_cast<std::int64_t>(0 - magnitude) : static_cast<std::int64_t>(magnitude);
+    return true;
+}
+
+bool CsvTable::GetUInt32(std::size_t row, std::size_t col, std::uint32_t& out) const
+{
+    std::int64_t v = 0;
+    if (!GetInt64(row, col, v) || v < 0 || v > static_cast<std::int64_t>(UINT32_MAX))
+        return false;
+
+    out = static_cast<std::uint32_t>(v);
+    return true;
 }
@@ -1,15 +1,116 @@
 ﻿#pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 
-// Simple CSV row type: column name -> value
-using CsvRow = std::unordered_map<std::string, std::string>;
+#include "mapped_file.hpp"
 
-// Read a CSV file into a vector of rows (map column -> value).
-// Returns an empty vector on failure.
-std::vector<CsvRow> read_csv(const std::string& path);
+// ============================================================================
+// CsvReader
+//
+// Single-pass RFC 4180 tokenizer over an in-memory buffer (typically a
+// MappedFile). Fields are string_views into the buffer: quoted fields keep
+// embedded commas and line breaks, and only a field containing doubled
+// quotes ("") needs Value() to build an unescaped copy.
+//
+// Lenient where real files are sloppy: a leading UTF-8 BOM is skipped,
+// LF and CRLF both end a record, blank lines are skipped, and text after a
+// closing quote is ignored up to the next delimiter (the record is
+// flagged Malformed()).
+// ============================================================================
+
+struct CsvField
+{
+    std::string_view text;      // without surrounding quotes
+    bool hasEscapes = false;    // text still contains "" pairs
+
+    // Unescaped value (copies only when hasEscapes is set)
+    std::string Value() const;
+};
+
+class CsvReader
+{
+public:
+    CsvReader(const char* data, std::size_t size);
+
+    // Next non-blank record; false at end of input. 'fields' is reused.
+    bool NextRecord(std::vector<CsvField>& fields);
+
+    // 1-based line on which the last record started
+    std::size_t LineNumber() const { return m_recordLine; }
+
+    bool Malformed() const { return m_malformed; }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+    std::size_t m_line = 1;
+    std::size_t m_recordLine = 0;
+    bool m_malformed = false;
+};
+
+// Whitespace-trimmed view
+std::string_view trim_view(std::string_view s);
+
+// ============================================================================
+// CsvTable
+//
+// Columnar view of a whole CSV file: the header is indexed once and each
+// column is a vector of trimmed string_views into the mapped file. Cells
+// that needed unescaping live in one shared side buffer. Loading costs a
+// handful of allocations regardless of cell count.
+//
+// Views stay valid for the lifetime of the table. Move-only.
+// ============================================================================
+
+class CsvTable
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Where a row came from, for diagnostics
+    struct RowInfo
+    {
+        std::size_t line = 0;       // 1-based line the record started on
+        std::size_t fields = 0;     // fields actually present (short rows are padded)
+        bool malformed = false;     // text after a closing quote (see CsvReader)
+    };
+
+    // Map and parse the file; the first record is the header
+    bool Load(const std::string& path);
+
+    std::size_t RowCount() const { return m_rowCount; }
+    const RowInfo& Row(std::size_t row) const { return m_rows[row]; }
+    std::size_t ColumnCount() const { return m_headers.size(); }
+
+    const std::string& ColumnName(std::size_t col) const { return m_headers[col]; }
+
+    // Case-insensitive header lookup; npos if absent
+    std::size_t ColumnIndex(std::string_view name) const;
+
+    // Whole column (one entry per row)
+    const std::vector<std::string_view>& Column(std::size_t col) const { return m_columns[col]; }
+
+    // Trimmed, unescaped cell; empty for cells past the end of a short row
+    std::string_view Get(std::size_t row, std::size_t col) const { return m_columns[col][row]; }
+    std::string GetString(std::size_t row, std::size_t col) const { return std::string(Get(row, col)); }
+
+    // Decimal (or 0x-prefixed hex) integer; false if empty or not a number
+    bool GetUInt32(std::size_t row, std::size_t col, std::uint32_t& out) const;
+    bool GetInt64(std::size_t row, std::size_t col, std::int64_t& out) const;
+
+private:
+    MappedFile m_file;
+    std::vector<std::string> m_headers;
+    std::vector<std::vector<std::string_view>> m_columns;
+    std::vector<RowInfo> m_rows;
+    std::vector<char> m_unescaped;           // backing store for cells with "" escapes; a
+                                             // heap buffer, so views survive a move (SSO would not)
+    std::size_t m_rowCount = 0;
+};
 
 // Trim leading and trailing whitespace from a string.
 std::string trim(const std::string& s);
@@ -1,111 +1,141 @@
 #include "pch.h"
 #include "csv_loader.hpp"
 #include "log.hpp"
+#include "stage_tracer.hpp"
+#include "csv.hpp"
 
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <cctype>
 
-// Trim helper
-static inline void trim(std::string& s)
-{
-    s.erase(s.begin(), std::find_if(s.begin(), s.end(),
-        [](unsigned char c) { return !std::isspace(c); }));
-
-    s.erase(std::find_if(s.rbegin(), s.rend(),
-        [](unsigned char c) { return !std::isspace(c); }).base(), s.end());
-}
-
-// Split a comma-separated list into vector<string>
-static std::vector<std::string> split_mod_list(const std::string& mods)
+// Split the Mods column ("A.esp, B.esp, ...") into trimmed names
+static std::vector<std::string> split_mod_list(std::string_view mods)
 {
     std::vector<std::string> result;
-    std::stringstream ss(mods);
-    std::string item;
 
-    while (std::getline(ss, item, ',')) {
-        trim(item);
+    while (!mods.empty()) {
+        const std::size_t comma = mods.find(',');
+        const std::string_view item = trim_view(mods.substr(0, comma));
         if (!item.empty())
-            result.push_back(item);
+            result.emplace_back(item);
+
+        if (comma == std::string_view::npos)
+            break;
+        mods.remove_prefix(comma + 1);
     }
 
     return result;
 }
 
+// Column position from the header, or the default when the header does not
+// name it. CSVBuilder writes DummySlot,Virtual_ID,Category,Mods; older files
+// had no Category column.
+static std::size_t locate_column(const CsvTable& table, const char* name, std::size_t fallback)
+{
+    const std::size_t col = table.ColumnIndex(name);
+    return col != CsvTable::npos ? col : fallback;
+}
+
 bool load_csv_slots(const std::string& path, std::vector<CSVSlot>& out)
 {
-    std::ifstream file(path);
-    if (!file.is_open()) {
+    StageTraceSpan span(TraceCat::Stage, "load_csv_slots");
+
+    CsvTable table;
+    if (!table.Load(path)) {
         logf("CSV ERROR: Could not open file '%s'", path.c_str());
         return false;
     }
 
-    std::string line;
-    size_t lineNum = 0;
+    const std::size_t dummyCol = locate_column(table, "DummySlot", 0);
+    const std::size_t virtualCol = locate_column(table, "Virtual_ID", 1);
+    const std::size_t modsCol = locate_column(table, "Mods", 2);
+    const std::size_t needed = std::max(dummyCol, std::max(virtualCol, modsCol)) + 1;
 
-    while (std::getline(file, line)) {
-        lineNum++;
+    out.reserve(out.size() + table.RowCount());
 
-        // Skip header row
-        if (lineNum == 1)
-            continue;
+    for (std::size_t row = 0; row < table.RowCount(); ++row) {
+        const CsvTable::RowInfo& info = table.Row(row);
 
-        // Handle BOM on first data line
-        if (lineNum == 2 && line.size() >= 3 &&
-            (unsigned char)line[0] == 0xEF &&
-            (unsigned char)line[1] == 0xBB &&
-            (unsigned char)line[2] == 0xBF)
-        {
-            line = line.substr(3);
-        }
+        if (info.malformed)
+            logf("CSV WARNING: Malformed quoting on line %zu", info.line);
 
-        if (line.empty())
+        // The table keeps only the header's columns, so a short header
+        // makes every row short
+        if (info.fields < needed || table.ColumnCount() < needed) {
+            logf("CSV WARNING: Expected %zu fields, found %zu on line %zu",
+                needed, std::min(info.fields, table.ColumnCount()), info.line);
             continue;
+        }
 
-        std::stringstream ss(line);
-        std::string dummy, virt, mods;
-
-        // Extract 3 CSV columns
-        if (!std::getline(ss, dummy, ',')) continue;
-        if (!std::getline(ss, virt, ',')) continue;
-        if (!std::getline(ss, mods, ',')) continue;
-
-        // Remove quotes
-        auto strip_quotes = [](std::string& s) {
-            trim(s);
-            if (!s.empty() && s.front() == '"') s.erase(0, 1);
-            if (!s.empty() && s.back() == '"') s.pop_back();
-            trim(s);
-            };
-
-        strip_quotes(dummy);
-        strip_quotes(virt);
-        strip_quotes(mods);
+        const std::string_view dummy = table.Get(row, dummyCol);
+        const std::string_view virt = table.Get(row, virtualCol);
+        const std::string_view mods = table.Get(row, modsCol);
 
         if (dummy.empty() || virt.empty() || mods.empty()) {
-            logf("CSV WARNING: Empty field on line %zu", lineNum);
+            logf("CSV WARNING: Empty field on line %zu", info.line);
             continue;
         }
 
-        // Parse virtual ID
-        uint32_t virtualID = 0;
-        try {
-            virtualID = std::stoul(virt, nullptr, 10);
-        }
-        catch (...) {
-            logf("CSV ERROR: Invalid Virtual_ID '%s' on line %zu", virt.c_str(), lineNum);
+        CSVSlot slot;
+        if (!table.GetUInt32(row, virtualCol, slot.virtualID)) {
+            logf("CSV ERROR: Invalid Virtual_ID '%.*s' on line %zu",
+                static_cast<int>(virt.size()), virt.data(), info.line);
             continue;
         }
 
-        CSVSlot slot;
-        slot.dummyPlugin = dummy;
-        slot.virtualID = virtualID;
+        slot.dummyPlugin = std::string(dummy);
         slot.sourceMods = split_mod_list(mods);
 
-        out.push_back(slot);
+        out.push_back(std::move(slot));
     }
 
     logf("CSV: Loaded %zu dummy slot entries from '%s'", out.size(), path.c_str());
     return true;
 }
+
+// ============================================================================
+// CSVSlotIndex
+// ============================================================================
+
+const std::vector<CSVSlot> CSVSlotIndex::s_noRows;
+
+static std::string fold_plugin_name(std::string_view name)
+{
+    std::string folded(name);
+    for (char& c : folded)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return folded;
+}
+
+void CSVSlotIndex::Build(const std::vector<CSVSlot>& slots)
+{
+    m_slots = &slots;
+    m_byName.clear();
+    m_duplicates.clear();
+
+    std::size_t total = 0;
+    for (const CSVSlot& slot : slots)
+        total += slot.sourceMods.size();
+    m_byName.reserve(total);
+
+    for (std::size_t row = 0; row < slots.size(); ++row)
+    {
+        for (const std::string& mod : slots[row].sourceMods)
+        {
+            const auto inserted = m_byName.emplace(fold_plugin_name(mod), row);
+            if (!inserted.second && inserted.first->second != row)
+                m_duplicates.push_back({ mod, inserted.first->second, row });
+        }
+    }
+}
+
+std::size_t CSVSlotIndex::FindRow(std::string_view pluginName) const
+{
+    const auto it = m_byName.find(fold_plugin_name(pluginName));
+    return it == m_byName.end() ? npos : it->second;
+}
+
+const CSVSlot* CSVSlotIndex::Find(std::string_view pluginName) const
+{
+    const std::size_t row = FindRow(pluginName);
+    return row == npos ? nullptr : &(*m_slots)[row];
+}
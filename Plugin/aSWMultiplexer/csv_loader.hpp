@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <cstdint>
 
@@ -17,3 +19,37 @@ struct CSVSlot {
 // Load all dummy slot mappings from the CSV file.
 // Returns true on success, false on failure.
 bool load_csv_slots(const std::string& path, std::vector<CSVSlot>& out);
+
+// Case-insensitive plugin name -> CSV row index, built once after the CSV
+// loads. When a plugin is listed in several rows the first row wins (as
+// the old linear search did) and the repeat is recorded in Duplicates().
+class CSVSlotIndex
+{
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    struct Duplicate {
+        std::string plugin;
+        std::size_t firstRow;    // 0-based index into Rows()
+        std::size_t repeatRow;
+    };
+
+    // 'slots' must outlive the index
+    void Build(const std::vector<CSVSlot>& slots);
+
+    // 0-based row for a plugin, or npos
+    std::size_t FindRow(std::string_view pluginName) const;
+    const CSVSlot* Find(std::string_view pluginName) const;
+
+    const std::vector<CSVSlot>& Rows() const { return *m_slots; }
+    bool Empty() const { return m_byName.empty(); }
+    std::size_t Size() const { return m_byName.size(); }
+    const std::vector<Duplicate>& Duplicates() const { return m_duplicates; }
+
+private:
+    static const std::vector<CSVSlot> s_noRows;
+
+    const std::vector<CSVSlot>* m_slots = &s_noRows;
+    std::unordered_map<std::string, std::size_t> m_byName;   // folded name -> row
+    std::vector<Duplicate> m_duplicates;
+};
@@ -5,6 +5,8 @@
 #include "config.hpp"
 #include "scanner.hpp"
 #include "mapping.hpp"
+#include "injector.hpp"
+#include "report_writer.hpp"
 
 #include <iostream>
 #include <fstream>
@@ -12,6 +14,14 @@
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <system_error>
+#include <cctype>
+#include <cstdio>
 
 // External globals from plugin.cpp
 extern std::unordered_map<std::string, std::string> g_pluginAliasMap;
@@ -24,23 +34,264 @@ extern bool g_consoleActive;
 // Internal Diagnostics State
 // ============================================================================
 
+// Appended from slot workers during the parallel pipeline; guarded together
+static std::mutex g_eventsMutex;
 static std::vector<DiagnosticsEvent> g_events;
-static std::unordered_map<std::string, PluginDiagnosticsSummary> g_pluginSummaries;
 static std::vector<std::string> g_slotConfigIssues;
 static std::vector<std::string> g_mappingIssues;
-static std::unordered_map<uint32_t, FormIDTraceResult> g_formIDTraces;
 
-// Simple helper to get or create a plugin summary
-static PluginDiagnosticsSummary& GetOrCreatePluginSummary(const std::string& pluginName)
+// ============================================================================
+// Per-plugin counters
+//
+// Every module gets a dense ID at registration (slot.cfg load). Counters live
+// in cache-line sized shards indexed by that ID, so concurrent scan/injection
+// workers never contend on a shared hash map or on each other's lines.
+// Shards are allocated in fixed-size chunks that are never moved or freed,
+// which keeps ID -> shard resolution lock-free.
+// ============================================================================
+
+struct alignas(64) PluginCounterShard
 {
-    auto it = g_pluginSummaries.find(pluginName);
-    if (it != g_pluginSummaries.end())
-        return it->second;
+    std::atomic<uint32_t> recordsScanned{ 0 };
+    std::atomic<uint32_t> recordsInjected{ 0 };
+    std::atomic<uint32_t> recordsSkipped{ 0 };
+    std::atomic<uint32_t> lvliRemaps{ 0 };
+};
+
+static_assert(sizeof(PluginCounterShard) == 64, "PluginCounterShard must occupy one cache line");
+
+static constexpr std::size_t kCounterChunkSize = 256;
+static constexpr std::size_t kMaxCounterChunks = 64;   // 16384 modules
+
+static std::array<std::atomic<PluginCounterShard*>, kMaxCounterChunks> g_counterChunks{};
+
+// Registry (name <-> ID); only touched on registration and when materializing
+static std::mutex g_pluginRegistryMutex;
+static std::unordered_map<std::string, PluginModuleId> g_pluginIdsByName;
+static std::vector<std::string> g_pluginNames;
+
+static std::string FoldPluginName(const std::string& name)
+{
+    std::string out = name;
+    std::transform(out.begin(), out.end(), out.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return out;
+}
+
+static PluginCounterShard* GetCounterShard(PluginModuleId id)
+{
+    if (id == kInvalidPluginModuleId)
+        return nullptr;
+
+    const std::size_t chunk = id / kCounterChunkSize;
+    if (chunk >= kMaxCounterChunks)
+        return nullptr;
+
+    PluginCounterShard* base = g_counterChunks[chunk].load(std::memory_order_acquire);
+    if (!base)
+        return nullptr;
+
+    return &base[id % kCounterChunkSize];
+}
+
+static void ResetCounterShards()
+{
+    for (auto& slot : g_counterChunks)
+    {
+        PluginCounterShard* base = slot.load(std::memory_order_acquire);
+        if (!base)
+            continue;
 
-    PluginDiagnosticsSummary summary;
-    summary.pluginName = pluginName;
-    auto inserted = g_pluginSummaries.emplace(pluginName, std::move(summary));
-    return inserted.first->second;
+        for (std::size_t i = 0; i < kCounterChunkSize; ++i)
+        {
+            base[i].recordsScanned.store(0, std::memory_order_relaxed);
+            base[i].recordsInjected.store(0, std::memory_order_relaxed);
+            base[i].recordsSkipped.store(0, std::memory_order_relaxed);
+            base[i].lvliRemaps.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// ============================================================================
+// FormID trace store
+//
+// Columnar: one entry is ~21 bytes spread over parallel arrays instead of a
+// hash node holding three strings. Plugin names, dummy slots and reasons are
+// stored as small codes. Appends are unsorted; the first query after a
+// recording seals the store (sort by FormID, keep the last trace per FormID,
+// build the per-module range index).
+//
+// Filled by the form-map builders (scan, precomputed table, ledger) when
+// debug logging is on; otherwise queries fall back to the live rewrite image.
+// ============================================================================
+
+struct FormIDTraceStore
+{
+    enum : uint8_t { kFlagESL = 0x01 };
+
+    // Columns (sorted by formID once sealed)
+    std::vector<uint32_t> formIDs;
+    std::vector<PluginModuleId> moduleIds;
+    std::vector<uint32_t> localKeys;
+    std::vector<uint32_t> virtualIDs;
+    std::vector<uint16_t> reasonCodes;
+    std::vector<uint16_t> dummySlotCodes;
+    std::vector<uint8_t> flags;
+
+    // Per-module secondary index: rows of module M are
+    // byModule[moduleOffsets[M] .. moduleOffsets[M + 1])
+    std::vector<uint32_t> byModule;
+    std::vector<uint32_t> moduleOffsets;
+
+    // Interned strings referenced by the code columns
+    std::vector<std::string> reasons;
+    std::vector<std::string> dummySlots;
+
+    bool sealed = true;
+};
+
+static std::mutex g_traceMutex;
+static FormIDTraceStore g_traces;
+
+static const char* const kBuiltinTraceReasons[] = {
+    "Mapped via module formIdMap",
+    "ESL compact key mapped via module formIdMap",
+    "Injected into CSV dummy slot",
+    "LVLI entry reference remapped",
+    "Mapped via precomputed form table",
+    "Kept FormID from formid_ledger.bin",
+};
+
+static_assert(sizeof(kBuiltinTraceReasons) / sizeof(kBuiltinTraceReasons[0]) ==
+    static_cast<std::size_t>(FormIDTraceReason::BuiltinCount),
+    "kBuiltinTraceReasons must match FormIDTraceReason");
+
+static uint16_t InternTraceString(std::vector<std::string>& table, const std::string& value)
+{
+    // Tables stay tiny (a handful of reasons, one entry per dummy slot),
+    // so a linear probe beats maintaining a second hash map.
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        if (table[i] == value)
+            return static_cast<uint16_t>(i);
+    }
+
+    if (table.size() >= 0xFFFF)
+        return 0xFFFF;
+
+    table.push_back(value);
+    return static_cast<uint16_t>(table.size() - 1);
+}
+
+static void ResetTraceStore()
+{
+    g_traces = FormIDTraceStore{};
+    for (const char* r : kBuiltinTraceReasons)
+        g_traces.reasons.emplace_back(r);
+}
+
+// Caller holds g_traceMutex
+static void SealTraceStore()
+{
+    FormIDTraceStore& t = g_traces;
+    if (t.sealed)
+        return;
+
+    const std::size_t n = t.formIDs.size();
+
+    // Stable order by FormID; for duplicates the last recorded trace wins
+    std::vector<uint32_t> order(n);
+    for (uint32_t i = 0; i < n; ++i)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(),
+        [&](uint32_t a, uint32_t b) { return t.formIDs[a] < t.formIDs[b]; });
+
+    std::vector<uint32_t> keep;
+    keep.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i + 1 < n && t.formIDs[order[i]] == t.formIDs[order[i + 1]])
+            continue;
+        keep.push_back(order[i]);
+    }
+
+    auto permute = [&](auto& column) {
+        std::remove_reference_t<decltype(column)> out;
+        out.reserve(keep.size());
+        for (uint32_t row : keep)
+            out.push_back(column[row]);
+        column.swap(out);
+        };
+
+    permute(t.formIDs);
+    permute(t.moduleIds);
+    permute(t.localKeys);
+    permute(t.virtualIDs);
+    permute(t.reasonCodes);
+    permute(t.dummySlotCodes);
+    permute(t.flags);
+
+    // Counting sort by module ID -> per-module ranges, FormID order preserved
+    PluginModuleId maxModule = 0;
+    for (PluginModuleId id : t.moduleIds) {
+        if (id != kInvalidPluginModuleId && id + 1 > maxModule)
+            maxModule = id + 1;
+    }
+
+    t.moduleOffsets.assign(static_cast<std::size_t>(maxModule) + 1, 0);
+    for (PluginModuleId id : t.moduleIds) {
+        if (id != kInvalidPluginModuleId)
+            ++t.moduleOffsets[id + 1];
+    }
+    for (std::size_t i = 1; i < t.moduleOffsets.size(); ++i)
+        t.moduleOffsets[i] += t.moduleOffsets[i - 1];
+
+    t.byModule.assign(t.moduleOffsets.back(), 0);
+    std::vector<uint32_t> cursor(t.moduleOffsets.begin(), t.moduleOffsets.end() - 1);
+    for (uint32_t row = 0; row < t.moduleIds.size(); ++row) {
+        const PluginModuleId id = t.moduleIds[row];
+        if (id != kInvalidPluginModuleId)
+            t.byModule[cursor[id]++] = row;
+    }
+
+    t.sealed = true;
+}
+
+// Caller holds g_traceMutex and has sealed the store
+static FormIDTraceResult MaterializeTrace(uint32_t row)
+{
+    const FormIDTraceStore& t = g_traces;
+
+    FormIDTraceResult res;
+    res.found = true;
+    res.pluginName = Diagnostics_GetPluginName(t.moduleIds[row]);
+    res.originalFormID = t.formIDs[row];
+    res.localKey = t.localKeys[row];
+    res.virtualFormID = t.virtualIDs[row];
+    res.isESL = (t.flags[row] & FormIDTraceStore::kFlagESL) != 0;
+
+    if (t.dummySlotCodes[row] < t.dummySlots.size())
+        res.dummySlot = t.dummySlots[t.dummySlotCodes[row]];
+    if (t.reasonCodes[row] < t.reasons.size())
+        res.reason = t.reasons[t.reasonCodes[row]];
+
+    return res;
+}
+
+static const char* EventTypeToString(DiagnosticsEventType type)
+{
+    switch (type)
+    {
+    case DiagnosticsEventType::Info:            return "INFO";
+    case DiagnosticsEventType::Warning:         return "WARN";
+    case DiagnosticsEventType::Error:           return "ERROR";
+    case DiagnosticsEventType::Remap:           return "REMAP";
+    case DiagnosticsEventType::Injection:       return "INJECT";
+    case DiagnosticsEventType::Scan:            return "SCAN";
+    case DiagnosticsEventType::MappingIssue:    return "MAPISSUE";
+    case DiagnosticsEventType::SlotConfigIssue: return "SLOTISSUE";
+    case DiagnosticsEventType::FormIDTrace:     return "FORMID";
+    }
+    return "UNKNOWN";
 }
 
 // ============================================================================
@@ -59,6 +310,8 @@ static void Cmd_DiagSlots();
 static void Cmd_DiagMappings();
 static void Cmd_DiagEvents();
 static void Cmd_DiagTrace(uint32_t formID);
+static void Cmd_DiagTracePlugin(const std::string& plugin);
+static void Cmd_BenchFormMaps();
 
 // ============================================================================
 // Initialization / Finalization
@@ -66,11 +319,25 @@ static void Cmd_DiagTrace(uint32_t formID);
 
 void Diagnostics_Initialize()
 {
-    g_events.clear();
-    g_pluginSummaries.clear();
-    g_slotConfigIssues.clear();
-    g_mappingIssues.clear();
-    g_formIDTraces.clear();
+    // A report from a previous run may still be writing
+    Diagnostics_WaitForReport();
+
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        g_events.clear();
+        g_slotConfigIssues.clear();
+        g_mappingIssues.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_pluginRegistryMutex);
+        g_pluginIdsByName.clear();
+        g_pluginNames.clear();
+        ResetCounterShards();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_traceMutex);
+        ResetTraceStore();
+    }
 
     DX("[Diagnostics] Initialized.");
     logf("[Diagnostics] Initialized.");
@@ -78,10 +345,15 @@ void Diagnostics_Initialize()
 
 void Diagnostics_Finalize()
 {
-    // Dump diagnostics to file at the end of initialization
-    Diagnostics_DumpToFile();
-    DX("[Diagnostics] Finalized (diagnostics written).");
-    logf("[Diagnostics] Finalized (diagnostics written).");
+    // Snapshot now, write the report on a worker thread
+    if (Diagnostics_StartReportAsync()) {
+        DX("[Diagnostics] Finalized (report writing in background).");
+        logf("[Diagnostics] Finalized (report writing in background).");
+    }
+    else {
+        DX("[Diagnostics] Finalized (diagnostics written).");
+        logf("[Diagnostics] Finalized (diagnostics written).");
+    }
 }
 
 // ============================================================================
@@ -149,6 +421,16 @@ void Diagnostics_HandleCommand(const std::string& cmdLine)
                     Cmd_DiagTrace(formID);
                 }
             }
+            else if (diagSub == "trace-plugin") {
+                // Plugin names may contain spaces; take the rest of the line
+                std::string plugin;
+                std::getline(ss, plugin);
+                plugin = trim_copy(plugin);
+                if (plugin.empty())
+                    DX("Usage: mx diag trace-plugin <plugin>");
+                else
+                    Cmd_DiagTracePlugin(plugin);
+            }
             else {
                 DX("mx diag commands:");
                 DX("  mx diag summary");
@@ -156,8 +438,18 @@ void Diagnostics_HandleCommand(const std::string& cmdLine)
                 DX("  mx diag mappings");
                 DX("  mx diag events");
                 DX("  mx diag trace <hexFormID>");
+                DX("  mx diag trace-plugin <plugin>");
             }
         }
+        else if (sub == "bench") {
+            std::string benchSub;
+            ss >> benchSub;
+
+            if (benchSub == "formmaps")
+                Cmd_BenchFormMaps();
+            else
+                DX("Usage: mx bench formmaps");
+        }
         else {
             DX("mx commands:");
             DX("  mx identity");
@@ -170,6 +462,8 @@ void Diagnostics_HandleCommand(const std::string& cmdLine)
             DX("  mx diag mappings");
             DX("  mx diag events");
             DX("  mx diag trace <hexFormID>");
+            DX("  mx diag trace-plugin <plugin>");
+            DX("  mx bench formmaps");
         }
     }
 }
@@ -292,14 +586,14 @@ static void Cmd_DiagSummary()
 {
     DX("=== Diagnostics: Plugin Summary ===");
 
-    if (g_pluginSummaries.empty()) {
+    const std::vector<PluginDiagnosticsSummary> summaries = Diagnostics_GetPluginSummaries();
+    if (summaries.empty()) {
         DX("No plugin diagnostics recorded.");
         return;
     }
 
-    for (auto& kv : g_pluginSummaries)
+    for (const auto& s : summaries)
     {
-        const auto& s = kv.second;
         std::stringstream line;
         line << s.pluginName
             << ": scanned=" << s.recordsScanned
@@ -313,51 +607,50 @@ static void Cmd_DiagSummary()
 static void Cmd_DiagSlots()
 {
     DX("=== Diagnostics: Slot Config Issues ===");
-    if (g_slotConfigIssues.empty()) {
+    std::vector<std::string> issues;
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        issues = g_slotConfigIssues;
+    }
+    if (issues.empty()) {
         DX("No slot.cfg issues detected.");
         return;
     }
-    for (auto& msg : g_slotConfigIssues)
+    for (auto& msg : issues)
         DX("  " + msg);
 }
 
 static void Cmd_DiagMappings()
 {
     DX("=== Diagnostics: Mapping Issues ===");
-    if (g_mappingIssues.empty()) {
+    std::vector<std::string> issues;
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        issues = g_mappingIssues;
+    }
+    if (issues.empty()) {
         DX("No mapping issues detected.");
         return;
     }
-    for (auto& msg : g_mappingIssues)
+    for (auto& msg : issues)
         DX("  " + msg);
 }
 
 static void Cmd_DiagEvents()
 {
     DX("=== Diagnostics: Events ===");
-    if (g_events.empty()) {
+    std::vector<DiagnosticsEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        events = g_events;
+    }
+    if (events.empty()) {
         DX("No diagnostics events recorded.");
         return;
     }
 
-    for (auto& ev : g_events)
-    {
-        std::string typeStr;
-        switch (ev.type)
-        {
-        case DiagnosticsEventType::Info:            typeStr = "INFO"; break;
-        case DiagnosticsEventType::Warning:         typeStr = "WARN"; break;
-        case DiagnosticsEventType::Error:           typeStr = "ERROR"; break;
-        case DiagnosticsEventType::Remap:           typeStr = "REMAP"; break;
-        case DiagnosticsEventType::Injection:       typeStr = "INJECT"; break;
-        case DiagnosticsEventType::Scan:            typeStr = "SCAN"; break;
-        case DiagnosticsEventType::MappingIssue:    typeStr = "MAPISSUE"; break;
-        case DiagnosticsEventType::SlotConfigIssue: typeStr = "SLOTISSUE"; break;
-        case DiagnosticsEventType::FormIDTrace:     typeStr = "FORMID"; break;
-        }
-
-        DX("[" + typeStr + "] " + ev.message);
-    }
+    for (auto& ev : events)
+        DX("[" << EventTypeToString(ev.type) << "] " << ev.message);
 }
 
 static void Cmd_DiagTrace(uint32_t formID)
@@ -366,24 +659,95 @@ static void Cmd_DiagTrace(uint32_t formID)
     hex << std::hex << std::uppercase << formID;
 
     DX("=== Diagnostics: FormID Trace 0x" + hex.str() + " ===");
+
+    // Explanations are recomputed from the live rewrite image on demand
+    const FormIDRewriteExplanation ex = ExplainFormIDRewriteLive(formID);
+
+    if (ex.module)
+    {
+        std::stringstream virt, local;
+        virt << std::hex << std::uppercase << ex.targetFormID;
+        local << std::hex << std::uppercase << ex.localKey;
+
+        DX("Plugin: " + ex.module->name);
+        DX("LocalKey: 0x" + local.str());
+        DX("Virtual: " + (ex.mapped ? "0x" + virt.str() : std::string("<unmapped>")));
+        DX("ESL: " + std::string(ex.module->isESL ? "YES" : "NO"));
+        if (ex.csvSlot)
+            DX("DummySlot: " + ex.csvSlot->dummyPlugin + " (CSV row " + std::to_string(ex.csvRow) + ")");
+    }
+
+    // A dummy-plugin FormID: name the record it was assigned to
+    VirtualFormIDSource source;
+    if (FindVirtualFormIDSource(formID, source))
+    {
+        std::stringstream local;
+        local << std::hex << std::uppercase << source.localKey;
+
+        DX("Virtual FormID of: " + source.module->name + " local 0x" + local.str() +
+            " (dummy slot " + source.slot->dummyName + ")");
+    }
+
+    DX("Reason chain:");
+    for (const auto& step : ex.chain)
+        DX("  - " + step);
+
+    // Explicitly recorded traces (if any) are shown as history
     FormIDTraceResult res = Diagnostics_QueryFormID(formID);
-    if (!res.found) {
-        DX("No trace found for this FormID.");
+    if (res.found) {
+        std::stringstream virt;
+        virt << std::hex << std::uppercase << res.virtualFormID;
+        DX("Recorded trace: " + res.pluginName + " -> 0x" + virt.str() + " (" + res.reason + ")");
+    }
+}
+
+static void Cmd_DiagTracePlugin(const std::string& plugin)
+{
+    DX("=== Diagnostics: FormID Traces for " + plugin + " ===");
+
+    const std::vector<FormIDTraceResult> traces = Diagnostics_QueryPluginTraces(plugin);
+    if (traces.empty()) {
+        // Nothing recorded: derive the rewrites from the live (sealed) form map
+        const ModuleDescriptor* mod = FindRewriteModuleByName(plugin);
+        if (!mod) {
+            DX("No traces recorded and plugin is not in the rewrite image.");
+            return;
+        }
+
+        std::vector<std::pair<uint32_t, uint32_t>> rows;
+        rows.reserve(mod->formIds.Size());
+        for (std::size_t i = 0; i < mod->formIds.Size(); ++i)
+            rows.emplace_back(mod->formIds.KeyAt(i), mod->formIds.ValueAt(i));
+        std::sort(rows.begin(), rows.end());
+
+        for (const auto& kv : rows)
+        {
+            std::stringstream line;
+            line << std::hex << std::uppercase
+                << "  local=0x" << kv.first
+                << " -> 0x" << kv.second
+                << (mod->isESL ? " (ESL)" : "");
+            DX(line.str());
+        }
+
+        DX(std::to_string(rows.size()) + " live mapping(s).");
         return;
     }
 
-    std::stringstream orig, virt, local;
-    orig << std::hex << std::uppercase << res.originalFormID;
-    virt << std::hex << std::uppercase << res.virtualFormID;
-    local << std::hex << std::uppercase << res.localKey;
+    for (const auto& t : traces)
+    {
+        std::stringstream line;
+        line << std::hex << std::uppercase
+            << "  0x" << t.originalFormID
+            << " -> 0x" << t.virtualFormID
+            << " (local=0x" << t.localKey
+            << (t.isESL ? ", ESL" : "")
+            << ", slot=" << t.dummySlot
+            << ") " << t.reason;
+        DX(line.str());
+    }
 
-    DX("Plugin: " + res.pluginName);
-    DX("Original: 0x" + orig.str());
-    DX("LocalKey: 0x" + local.str());
-    DX("Virtual: 0x" + virt.str());
-    DX("ESL: " + std::string(res.isESL ? "YES" : "NO"));
-    DX("DummySlot: " + res.dummySlot);
-    DX("Reason: " + res.reason);
+    DX(std::to_string(traces.size()) + " trace(s).");
 }
 
 // ============================================================================
@@ -423,45 +787,174 @@ void Diagnostics_RecordEvent(DiagnosticsEventType type, const std::string& messa
     DiagnosticsEvent ev;
     ev.type = type;
     ev.message = message;
+
+    std::lock_guard<std::mutex> lock(g_eventsMutex);
     g_events.push_back(std::move(ev));
 }
 
+PluginModuleId Diagnostics_RegisterPlugin(const std::string& pluginName)
+{
+    const std::string key = FoldPluginName(pluginName);
+
+    std::lock_guard<std::mutex> lock(g_pluginRegistryMutex);
+
+    auto it = g_pluginIdsByName.find(key);
+    if (it != g_pluginIdsByName.end())
+        return it->second;
+
+    const PluginModuleId id = static_cast<PluginModuleId>(g_pluginNames.size());
+    const std::size_t chunk = id / kCounterChunkSize;
+    if (chunk >= kMaxCounterChunks) {
+        logf("[Diagnostics] WARNING: Plugin counter capacity exhausted; '%s' will not be tracked.",
+            pluginName.c_str());
+        return kInvalidPluginModuleId;
+    }
+
+    if (!g_counterChunks[chunk].load(std::memory_order_relaxed))
+        g_counterChunks[chunk].store(new PluginCounterShard[kCounterChunkSize], std::memory_order_release);
+
+    g_pluginNames.push_back(pluginName);
+    g_pluginIdsByName.emplace(key, id);
+    return id;
+}
+
+PluginModuleId Diagnostics_FindPluginId(const std::string& pluginName)
+{
+    const std::string key = FoldPluginName(pluginName);
+
+    std::lock_guard<std::mutex> lock(g_pluginRegistryMutex);
+    auto it = g_pluginIdsByName.find(key);
+    return it != g_pluginIdsByName.end() ? it->second : kInvalidPluginModuleId;
+}
+
+std::string Diagnostics_GetPluginName(PluginModuleId id)
+{
+    std::lock_guard<std::mutex> lock(g_pluginRegistryMutex);
+    if (id >= g_pluginNames.size())
+        return std::string();
+    return g_pluginNames[id];
+}
+
+void Diagnostics_RecordPluginScan(PluginModuleId id)
+{
+    if (auto* s = GetCounterShard(id))
+        s->recordsScanned.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Diagnostics_RecordPluginInjection(PluginModuleId id)
+{
+    if (auto* s = GetCounterShard(id))
+        s->recordsInjected.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Diagnostics_RecordPluginSkip(PluginModuleId id)
+{
+    if (auto* s = GetCounterShard(id))
+        s->recordsSkipped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Diagnostics_RecordPluginLVLIRemap(PluginModuleId id)
+{
+    if (auto* s = GetCounterShard(id))
+        s->lvliRemaps.fetch_add(1, std::memory_order_relaxed);
+}
+
 void Diagnostics_RecordPluginScan(const std::string& pluginName)
 {
-    auto& s = GetOrCreatePluginSummary(pluginName);
-    ++s.recordsScanned;
+    Diagnostics_RecordPluginScan(Diagnostics_RegisterPlugin(pluginName));
 }
 
 void Diagnostics_RecordPluginInjection(const std::string& pluginName)
 {
-    auto& s = GetOrCreatePluginSummary(pluginName);
-    ++s.recordsInjected;
+    Diagnostics_RecordPluginInjection(Diagnostics_RegisterPlugin(pluginName));
 }
 
 void Diagnostics_RecordPluginSkip(const std::string& pluginName)
 {
-    auto& s = GetOrCreatePluginSummary(pluginName);
-    ++s.recordsSkipped;
+    Diagnostics_RecordPluginSkip(Diagnostics_RegisterPlugin(pluginName));
 }
 
 void Diagnostics_RecordPluginLVLIRemap(const std::string& pluginName)
 {
-    auto& s = GetOrCreatePluginSummary(pluginName);
-    ++s.lvliRemaps;
+    Diagnostics_RecordPluginLVLIRemap(Diagnostics_RegisterPlugin(pluginName));
 }
 
 void Diagnostics_RecordSlotConfigIssue(const std::string& message)
 {
-    g_slotConfigIssues.push_back(message);
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        g_slotConfigIssues.push_back(message);
+    }
     Diagnostics_RecordEvent(DiagnosticsEventType::SlotConfigIssue, message);
 }
 
 void Diagnostics_RecordMappingIssue(const std::string& message)
 {
-    g_mappingIssues.push_back(message);
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        g_mappingIssues.push_back(message);
+    }
     Diagnostics_RecordEvent(DiagnosticsEventType::MappingIssue, message);
 }
 
+void Diagnostics_RecordFormIDTrace(
+    PluginModuleId moduleId,
+    uint32_t originalFormID,
+    uint32_t localKey,
+    uint32_t virtualFormID,
+    bool isESL,
+    const std::string& dummySlot,
+    FormIDTraceReason reason
+)
+{
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    FormIDTraceStore& t = g_traces;
+
+    if (t.reasons.empty())
+        ResetTraceStore();
+
+    t.formIDs.push_back(originalFormID);
+    t.moduleIds.push_back(moduleId);
+    t.localKeys.push_back(localKey);
+    t.virtualIDs.push_back(virtualFormID);
+    t.reasonCodes.push_back(static_cast<uint16_t>(reason));
+    t.dummySlotCodes.push_back(InternTraceString(t.dummySlots, dummySlot));
+    t.flags.push_back(isESL ? FormIDTraceStore::kFlagESL : 0);
+    t.sealed = false;
+}
+
+void Diagnostics_RecordFormIDTraces(
+    PluginModuleId moduleId,
+    bool isESL,
+    const std::string& dummySlot,
+    const std::vector<FormIDTraceRow>& rows
+)
+{
+    if (rows.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    FormIDTraceStore& t = g_traces;
+
+    if (t.reasons.empty())
+        ResetTraceStore();
+
+    const uint16_t slotCode = InternTraceString(t.dummySlots, dummySlot);
+    const uint8_t flags = isESL ? FormIDTraceStore::kFlagESL : 0;
+
+    for (const FormIDTraceRow& r : rows)
+    {
+        t.formIDs.push_back(r.originalFormID);
+        t.moduleIds.push_back(moduleId);
+        t.localKeys.push_back(r.localKey);
+        t.virtualIDs.push_back(r.virtualFormID);
+        t.reasonCodes.push_back(static_cast<uint16_t>(r.reason));
+        t.dummySlotCodes.push_back(slotCode);
+        t.flags.push_back(flags);
+    }
+    t.sealed = false;
+}
+
 void Diagnostics_RecordFormIDTrace(
     const std::string& pluginName,
     uint32_t originalFormID,
@@ -472,146 +965,449 @@ void Diagnostics_RecordFormIDTrace(
     const std::string& reason
 )
 {
-    FormIDTraceResult res;
-    res.found = true;
-    res.pluginName = pluginName;
-    res.originalFormID = originalFormID;
-    res.localKey = localKey;
-    res.virtualFormID = virtualFormID;
-    res.isESL = isESL;
-    res.dummySlot = dummySlot;
-    res.reason = reason;
+    const PluginModuleId moduleId = Diagnostics_RegisterPlugin(pluginName);
 
-    g_formIDTraces[originalFormID] = res;
+    uint16_t reasonCode = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_traceMutex);
+        if (g_traces.reasons.empty())
+            ResetTraceStore();
+        reasonCode = InternTraceString(g_traces.reasons, reason);
+    }
 
-    std::stringstream msg;
-    msg << pluginName << ": 0x" << std::hex << std::uppercase << originalFormID
-        << " -> 0x" << virtualFormID << " (" << reason << ")";
-    Diagnostics_RecordEvent(DiagnosticsEventType::FormIDTrace, msg.str());
+    Diagnostics_RecordFormIDTrace(
+        moduleId, originalFormID, localKey, virtualFormID, isESL, dummySlot,
+        static_cast<FormIDTraceReason>(reasonCode));
 }
 
 // ============================================================================
 // Query API
 // ============================================================================
 
+std::vector<PluginDiagnosticsSummary> Diagnostics_GetPluginSummaries()
+{
+    std::vector<PluginDiagnosticsSummary> out;
+
+    std::lock_guard<std::mutex> lock(g_pluginRegistryMutex);
+    out.reserve(g_pluginNames.size());
+
+    for (PluginModuleId id = 0; id < g_pluginNames.size(); ++id)
+    {
+        const PluginCounterShard* shard = GetCounterShard(id);
+        if (!shard)
+            continue;
+
+        PluginDiagnosticsSummary s;
+        s.pluginName = g_pluginNames[id];
+        s.recordsScanned = shard->recordsScanned.load(std::memory_order_relaxed);
+        s.recordsInjected = shard->recordsInjected.load(std::memory_order_relaxed);
+        s.recordsSkipped = shard->recordsSkipped.load(std::memory_order_relaxed);
+        s.lvliRemaps = shard->lvliRemaps.load(std::memory_order_relaxed);
+
+        if (s.recordsScanned == 0 && s.recordsInjected == 0 &&
+            s.recordsSkipped == 0 && s.lvliRemaps == 0)
+            continue;
+
+        out.push_back(std::move(s));
+    }
+
+    return out;
+}
+
 FormIDTraceResult Diagnostics_QueryFormID(uint32_t formID)
 {
-    auto it = g_formIDTraces.find(formID);
-    if (it != g_formIDTraces.end())
-        return it->second;
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    SealTraceStore();
+
+    const auto& ids = g_traces.formIDs;
+    auto it = std::lower_bound(ids.begin(), ids.end(), formID);
+    if (it != ids.end() && *it == formID)
+        return MaterializeTrace(static_cast<uint32_t>(it - ids.begin()));
 
     FormIDTraceResult res;
     res.found = false;
     return res;
 }
 
+std::vector<FormIDTraceResult> Diagnostics_QueryPluginTraces(const std::string& pluginName)
+{
+    std::vector<FormIDTraceResult> out;
+
+    const PluginModuleId id = Diagnostics_FindPluginId(pluginName);
+    if (id == kInvalidPluginModuleId)
+        return out;
+
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    SealTraceStore();
+
+    const FormIDTraceStore& t = g_traces;
+    if (static_cast<std::size_t>(id) + 1 >= t.moduleOffsets.size())
+        return out;
+
+    const uint32_t begin = t.moduleOffsets[id];
+    const uint32_t end = t.moduleOffsets[id + 1];
+    out.reserve(end - begin);
+
+    for (uint32_t i = begin; i < end; ++i)
+        out.push_back(MaterializeTrace(t.byModule[i]));
+
+    return out;
+}
+
+std::size_t Diagnostics_GetFormIDTraceCount()
+{
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    SealTraceStore();
+    return g_traces.formIDs.size();
+}
+
 // ============================================================================
 // Dump API
+//
+// The report is written from a point-in-time snapshot, so the (potentially
+// large) formatting and file I/O can run on a worker thread while the game
+// keeps loading. Output goes through BufferedReportWriter: one 1 MiB buffer,
+// no iostream formatting per field.
 // ============================================================================
 
-void Diagnostics_DumpToFile()
+struct DiagnosticsReportSnapshot
 {
-    const char* path = "Data\\F4SE\\Plugins\\Multiplexer\\diagnostics.txt";
-    std::ofstream out(path);
-    if (!out.is_open()) {
+    std::vector<PluginDiagnosticsSummary> summaries;
+    std::vector<std::string> slotConfigIssues;
+    std::vector<std::string> mappingIssues;
+    std::vector<DiagnosticsEvent> events;
+
+    // Sealed copy of the trace columns + the names their codes refer to
+    FormIDTraceStore traces;
+    std::vector<std::string> pluginNames;
+
+    bool writeText = true;
+    bool writeJsonLines = false;
+};
+
+static const char* kReportTextPath = "Data\\F4SE\\Plugins\\Multiplexer\\diagnostics.txt";
+static const char* kReportJsonLinesPath = "Data\\F4SE\\Plugins\\Multiplexer\\diagnostics.jsonl";
+
+// Joined on destruction so a report still in flight at shutdown is completed
+struct DiagnosticsReportWorker
+{
+    std::thread thread;
+    ~DiagnosticsReportWorker() { if (thread.joinable()) thread.join(); }
+};
+
+static std::mutex g_reportWorkerMutex;
+static DiagnosticsReportWorker g_reportWorker;
+
+static void ResolveReportFormats(DiagnosticsReportSnapshot& snap)
+{
+    std::string fmt = g_diagnosticsFormat;
+    std::transform(fmt.begin(), fmt.end(), fmt.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (fmt == "jsonl" || fmt == "json") {
+        snap.writeText = false;
+        snap.writeJsonLines = true;
+    }
+    else if (fmt == "both") {
+        snap.writeText = true;
+        snap.writeJsonLines = true;
+    }
+    else {
+        snap.writeText = true;
+        snap.writeJsonLines = false;
+    }
+}
+
+static std::shared_ptr<DiagnosticsReportSnapshot> CaptureReportSnapshot()
+{
+    auto snap = std::make_shared<DiagnosticsReportSnapshot>();
+
+    ResolveReportFormats(*snap);
+    snap->summaries = Diagnostics_GetPluginSummaries();
+    {
+        std::lock_guard<std::mutex> lock(g_eventsMutex);
+        snap->slotConfigIssues = g_slotConfigIssues;
+        snap->mappingIssues = g_mappingIssues;
+        snap->events = g_events;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_traceMutex);
+        SealTraceStore();
+        snap->traces = g_traces;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_pluginRegistryMutex);
+        snap->pluginNames = g_pluginNames;
+    }
+
+    return snap;
+}
+
+static const std::string& SnapshotString(const std::vector<std::string>& table, std::size_t index)
+{
+    static const std::string kEmpty;
+    return index < table.size() ? table[index] : kEmpty;
+}
+
+static bool WriteTextReport(const DiagnosticsReportSnapshot& snap, const char* path)
+{
+    BufferedReportWriter out;
+    if (!out.Open(path)) {
         logf("Diagnostics_DumpToFile: Could not open diagnostics.txt for writing.");
-        return;
+        return false;
     }
 
-    out << "=== Multiplexer Diagnostics ===\n\n";
+    out.Write("=== Multiplexer Diagnostics ===\n\n");
 
     // Plugin summaries
-    out << "[Plugin Summaries]\n";
-    if (g_pluginSummaries.empty()) {
-        out << "  (none)\n";
+    out.Write("[Plugin Summaries]\n");
+    if (snap.summaries.empty()) {
+        out.Write("  (none)\n");
     }
     else {
-        for (auto& kv : g_pluginSummaries)
+        for (const auto& s : snap.summaries)
         {
-            const auto& s = kv.second;
-            out << "  " << s.pluginName
-                << ": scanned=" << s.recordsScanned
-                << " injected=" << s.recordsInjected
-                << " skipped=" << s.recordsSkipped
-                << " lvliRemaps=" << s.lvliRemaps
-                << "\n";
+            out.Write("  ");
+            out.Write(s.pluginName);
+            out.Write(": scanned=");   out.WriteUInt(s.recordsScanned);
+            out.Write(" injected=");   out.WriteUInt(s.recordsInjected);
+            out.Write(" skipped=");    out.WriteUInt(s.recordsSkipped);
+            out.Write(" lvliRemaps="); out.WriteUInt(s.lvliRemaps);
+            out.Put('\n');
         }
     }
-    out << "\n";
+    out.Put('\n');
 
     // Slot config issues
-    out << "[Slot Config Issues]\n";
-    if (g_slotConfigIssues.empty()) {
-        out << "  (none)\n";
+    out.Write("[Slot Config Issues]\n");
+    if (snap.slotConfigIssues.empty()) {
+        out.Write("  (none)\n");
     }
     else {
-        for (auto& msg : g_slotConfigIssues)
-            out << "  " << msg << "\n";
+        for (const auto& msg : snap.slotConfigIssues) {
+            out.Write("  ");
+            out.Write(msg);
+            out.Put('\n');
+        }
     }
-    out << "\n";
+    out.Put('\n');
 
     // Mapping issues
-    out << "[Mapping Issues]\n";
-    if (g_mappingIssues.empty()) {
-        out << "  (none)\n";
+    out.Write("[Mapping Issues]\n");
+    if (snap.mappingIssues.empty()) {
+        out.Write("  (none)\n");
     }
     else {
-        for (auto& msg : g_mappingIssues)
-            out << "  " << msg << "\n";
+        for (const auto& msg : snap.mappingIssues) {
+            out.Write("  ");
+            out.Write(msg);
+            out.Put('\n');
+        }
     }
-    out << "\n";
+    out.Put('\n');
 
     // Events
-    out << "[Events]\n";
-    if (g_events.empty()) {
-        out << "  (none)\n";
+    out.Write("[Events]\n");
+    if (snap.events.empty()) {
+        out.Write("  (none)\n");
     }
     else {
-        for (auto& ev : g_events)
+        for (const auto& ev : snap.events)
         {
-            const char* typeStr = "UNKNOWN";
-            switch (ev.type)
-            {
-            case DiagnosticsEventType::Info:            typeStr = "INFO"; break;
-            case DiagnosticsEventType::Warning:         typeStr = "WARN"; break;
-            case DiagnosticsEventType::Error:           typeStr = "ERROR"; break;
-            case DiagnosticsEventType::Remap:           typeStr = "REMAP"; break;
-            case DiagnosticsEventType::Injection:       typeStr = "INJECT"; break;
-            case DiagnosticsEventType::Scan:            typeStr = "SCAN"; break;
-            case DiagnosticsEventType::MappingIssue:    typeStr = "MAPISSUE"; break;
-            case DiagnosticsEventType::SlotConfigIssue: typeStr = "SLOTISSUE"; break;
-            case DiagnosticsEventType::FormIDTrace:     typeStr = "FORMID"; break;
-            }
-            out << "  [" << typeStr << "] " << ev.message << "\n";
+            out.Write("  [");
+            out.Write(EventTypeToString(ev.type));
+            out.Write("] ");
+            out.Write(ev.message);
+            out.Put('\n');
         }
     }
-    out << "\n";
+    out.Put('\n');
 
     // FormID traces
-    out << "[FormID Traces]\n";
-    if (g_formIDTraces.empty()) {
-        out << "  (none)\n";
+    out.Write("[FormID Traces]\n");
+    const FormIDTraceStore& t = snap.traces;
+    if (t.formIDs.empty()) {
+        out.Write("  (none)\n");
     }
     else {
-        for (auto& kv : g_formIDTraces)
+        for (std::size_t row = 0; row < t.formIDs.size(); ++row)
         {
-            const auto& t = kv.second;
-            std::stringstream orig, virt, local;
-            orig << std::hex << std::uppercase << t.originalFormID;
-            virt << std::hex << std::uppercase << t.virtualFormID;
-            local << std::hex << std::uppercase << t.localKey;
-
-            out << "  Plugin: " << t.pluginName << "\n";
-            out << "    Original: 0x" << orig.str() << "\n";
-            out << "    LocalKey: 0x" << local.str() << "\n";
-            out << "    Virtual:  0x" << virt.str() << "\n";
-            out << "    ESL:      " << (t.isESL ? "YES" : "NO") << "\n";
-            out << "    DummySlot:" << t.dummySlot << "\n";
-            out << "    Reason:   " << t.reason << "\n";
+            out.Write("  Plugin: ");
+            out.Write(SnapshotString(snap.pluginNames, t.moduleIds[row]));
+            out.Write("\n    Original: 0x"); out.WriteHex(t.formIDs[row]);
+            out.Write("\n    LocalKey: 0x"); out.WriteHex(t.localKeys[row]);
+            out.Write("\n    Virtual:  0x"); out.WriteHex(t.virtualIDs[row]);
+            out.Write("\n    ESL:      ");
+            out.Write((t.flags[row] & FormIDTraceStore::kFlagESL) ? "YES" : "NO");
+            out.Write("\n    DummySlot:");
+            out.Write(SnapshotString(t.dummySlots, t.dummySlotCodes[row]));
+            out.Write("\n    Reason:   ");
+            out.Write(SnapshotString(t.reasons, t.reasonCodes[row]));
+            out.Put('\n');
         }
     }
-    out << "\n";
+    out.Put('\n');
+
+    if (!out.Close()) {
+        logf("Diagnostics_DumpToFile: write to diagnostics.txt failed.");
+        return false;
+    }
 
-    out.close();
     logf("Diagnostics_DumpToFile: diagnostics.txt written.");
+    return true;
+}
+
+// One self-describing JSON object per line, keyed by "kind"
+static bool WriteJsonLinesReport(const DiagnosticsReportSnapshot& snap, const char* path)
+{
+    BufferedReportWriter out;
+    if (!out.Open(path)) {
+        logf("Diagnostics_DumpToFile: Could not open diagnostics.jsonl for writing.");
+        return false;
+    }
+
+    auto writeMessageLine = [&](const char* kind, const std::string& message) {
+        out.Write("{\"kind\":\"");
+        out.Write(kind);
+        out.Write("\",\"message\":");
+        out.WriteJsonString(message);
+        out.Write("}\n");
+        };
+
+    const FormIDTraceStore& t = snap.traces;
+
+    out.Write("{\"kind\":\"header\",\"report\":\"multiplexer-diagnostics\",\"version\":1");
+    out.Write(",\"plugins\":");       out.WriteUInt(snap.summaries.size());
+    out.Write(",\"slotIssues\":");    out.WriteUInt(snap.slotConfigIssues.size());
+    out.Write(",\"mappingIssues\":"); out.WriteUInt(snap.mappingIssues.size());
+    out.Write(",\"events\":");        out.WriteUInt(snap.events.size());
+    out.Write(",\"traces\":");        out.WriteUInt(t.formIDs.size());
+    out.Write("}\n");
+
+    for (const auto& s : snap.summaries)
+    {
+        out.Write("{\"kind\":\"summary\",\"plugin\":");
+        out.WriteJsonString(s.pluginName);
+        out.Write(",\"scanned\":");    out.WriteUInt(s.recordsScanned);
+        out.Write(",\"injected\":");   out.WriteUInt(s.recordsInjected);
+        out.Write(",\"skipped\":");    out.WriteUInt(s.recordsSkipped);
+        out.Write(",\"lvliRemaps\":"); out.WriteUInt(s.lvliRemaps);
+        out.Write("}\n");
+    }
+
+    for (const auto& msg : snap.slotConfigIssues)
+        writeMessageLine("slotIssue", msg);
+
+    for (const auto& msg : snap.mappingIssues)
+        writeMessageLine("mappingIssue", msg);
+
+    for (const auto& ev : snap.events)
+    {
+        out.Write("{\"kind\":\"event\",\"type\":\"");
+        out.Write(EventTypeToString(ev.type));
+        out.Write("\",\"message\":");
+        out.WriteJsonString(ev.message);
+        out.Write("}\n");
+    }
+
+    for (std::size_t row = 0; row < t.formIDs.size(); ++row)
+    {
+        out.Write("{\"kind\":\"trace\",\"plugin\":");
+        out.WriteJsonString(SnapshotString(snap.pluginNames, t.moduleIds[row]));
+        out.Write(",\"original\":\"0x");  out.WriteHex8(t.formIDs[row]);
+        out.Write("\",\"localKey\":\"0x"); out.WriteHex8(t.localKeys[row]);
+        out.Write("\",\"virtual\":\"0x");  out.WriteHex8(t.virtualIDs[row]);
+        out.Write("\",\"esl\":");
+        out.Write((t.flags[row] & FormIDTraceStore::kFlagESL) ? "true" : "false");
+        out.Write(",\"dummySlot\":");
+        out.WriteJsonString(SnapshotString(t.dummySlots, t.dummySlotCodes[row]));
+        out.Write(",\"reason\":");
+        out.WriteJsonString(SnapshotString(t.reasons, t.reasonCodes[row]));
+        out.Write("}\n");
+    }
+
+    if (!out.Close()) {
+        logf("Diagnostics_DumpToFile: write to diagnostics.jsonl failed.");
+        return false;
+    }
+
+    logf("Diagnostics_DumpToFile: diagnostics.jsonl written.");
+    return true;
+}
+
+static void WriteReports(const DiagnosticsReportSnapshot& snap)
+{
+    if (snap.writeText)
+        WriteTextReport(snap, kReportTextPath);
+    if (snap.writeJsonLines)
+        WriteJsonLinesReport(snap, kReportJsonLinesPath);
+}
+
+void Diagnostics_WaitForReport()
+{
+    std::lock_guard<std::mutex> lock(g_reportWorkerMutex);
+    if (g_reportWorker.thread.joinable())
+        g_reportWorker.thread.join();
+}
+
+bool Diagnostics_StartReportAsync()
+{
+    Diagnostics_WaitForReport();
+
+    std::shared_ptr<DiagnosticsReportSnapshot> snap = CaptureReportSnapshot();
+
+    std::lock_guard<std::mutex> lock(g_reportWorkerMutex);
+    try {
+        g_reportWorker.thread = std::thread([snap]() { WriteReports(*snap); });
+    }
+    catch (const std::system_error&) {
+        // No thread available: write inline rather than lose the report
+        logf("Diagnostics: could not start report thread; writing synchronously.");
+        WriteReports(*snap);
+        return false;
+    }
+
+    return true;
+}
+
+void Diagnostics_DumpToFile()
+{
+    Diagnostics_WaitForReport();
+    WriteReports(*CaptureReportSnapshot());
+}
+
+static void Cmd_BenchFormMaps()
+{
+    DX("=== Benchmark: sealed form maps vs std::unordered_map ===");
+
+    const std::vector<FormMapBenchResult> rows = BenchmarkFormMaps();
+    if (rows.empty()) {
+        DX("No form maps in the rewrite image.");
+        return;
+    }
+
+    std::size_t entries = 0, sealedBytes = 0, mapBytes = 0;
+    double sealedNs = 0.0, mapNs = 0.0;
+
+    for (const auto& r : rows)
+    {
+        char line[256];
+        std::snprintf(line, sizeof(line), "  %-40s %8zu keys  sealed %6.1f ns %9zu B  map %6.1f ns %9zu B",
+            r.module.c_str(), r.entries, r.sealedNs, r.sealedBytes, r.mapNs, r.mapBytes);
+        DX(line);
+        logf("BenchFormMaps:%s", line + 1);
+
+        entries += r.entries;
+        sealedBytes += r.sealedBytes;
+        mapBytes += r.mapBytes;
+        sealedNs += r.sealedNs * r.entries;
+        mapNs += r.mapNs * r.entries;
+    }
+
+    char total[256];
+    std::snprintf(total, sizeof(total), "%zu modules, %zu keys: sealed %.1f ns/lookup, %zu B; map %.1f ns/lookup, ~%zu B",
+        rows.size(), entries, sealedNs / entries, sealedBytes, mapNs / entries, mapBytes);
+    DX(total);
+    logf("BenchFormMaps: %s", total);
 }
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 // ------------------------------------------------------------
 // Diagnostics Event Types
@@ -24,7 +25,13 @@ enum class DiagnosticsEventType
 // Public Data Structures
 // ------------------------------------------------------------
 
-// Summary of a plugin's activity during scanning/injection
+// Dense per-module identifier, assigned when slot.cfg is loaded.
+// Used to index the lock-free per-plugin counter shards.
+using PluginModuleId = uint32_t;
+constexpr PluginModuleId kInvalidPluginModuleId = 0xFFFFFFFFu;
+
+// Summary of a plugin's activity during scanning/injection.
+// Materialized on demand from the per-module counter shards.
 struct PluginDiagnosticsSummary
 {
     std::string pluginName;
@@ -41,7 +48,21 @@ struct DiagnosticsEvent
     std::string message;
 };
 
-// FormID remap trace result
+// Built-in reason codes for recorded FormID traces.
+// Free-form reasons passed by name are interned after these.
+enum class FormIDTraceReason : uint16_t
+{
+    FormIdMap = 0,        // Local key mapped through the module formIdMap
+    ESLCompactKey,        // ESL compact (12-bit) key mapped through formIdMap
+    CSVSlotInjection,     // Record injected into its CSV dummy slot
+    LVLIReference,        // LVLI entry reference remapped
+    PrecomputedTable,     // Mapped via csvbuilder's precomputed form table
+    LedgerAssignment,     // Kept the FormID formid_ledger.bin already held
+
+    BuiltinCount
+};
+
+// FormID remap trace result (materialized from the columnar trace store)
 struct FormIDTraceResult
 {
     bool found = false;
@@ -62,6 +83,7 @@ struct FormIDTraceResult
 void Diagnostics_Initialize();
 
 // Called by plugin.cpp at the end of initialization
+// (starts the background report write; does not block on file I/O)
 void Diagnostics_Finalize();
 
 // Called by plugin.cpp at startup to validate slot.cfg, CSV, etc.
@@ -77,7 +99,24 @@ void Diagnostics_HandleCommand(const std::string& cmdLine);
 // Record a generic diagnostics event
 void Diagnostics_RecordEvent(DiagnosticsEventType type, const std::string& message);
 
-// Record plugin-level summary data
+// Assign (or return the existing) dense module ID for a plugin name.
+// Names are matched case-insensitively. Registration takes a lock;
+// recording against the returned ID does not.
+PluginModuleId Diagnostics_RegisterPlugin(const std::string& pluginName);
+
+// Look up a previously registered plugin; kInvalidPluginModuleId if unknown.
+PluginModuleId Diagnostics_FindPluginId(const std::string& pluginName);
+
+// Registered name for a module ID (empty if unknown).
+std::string Diagnostics_GetPluginName(PluginModuleId id);
+
+// Record plugin-level summary data (thread-safe, lock-free by ID)
+void Diagnostics_RecordPluginScan(PluginModuleId id);
+void Diagnostics_RecordPluginInjection(PluginModuleId id);
+void Diagnostics_RecordPluginSkip(PluginModuleId id);
+void Diagnostics_RecordPluginLVLIRemap(PluginModuleId id);
+
+// Name-based convenience overloads (register on first use)
 void Diagnostics_RecordPluginScan(const std::string& pluginName);
 void Diagnostics_RecordPluginInjection(const std::string& pluginName);
 void Diagnostics_RecordPluginSkip(const std::string& pluginName);
@@ -89,7 +128,36 @@ void Diagnostics_RecordSlotConfigIssue(const std::string& message);
 // Record mapping issues (missing FormIDs, collisions, etc.)
 void Diagnostics_RecordMappingIssue(const std::string& message);
 
-// Record a FormID remap explanation
+// Record a FormID remap explanation (columnar, no per-trace strings).
+// dummySlot is interned; pass the same string for every trace of a slot.
+void Diagnostics_RecordFormIDTrace(
+    PluginModuleId moduleId,
+    uint32_t originalFormID,
+    uint32_t localKey,
+    uint32_t virtualFormID,
+    bool isESL,
+    const std::string& dummySlot,
+    FormIDTraceReason reason
+);
+
+// One trace of a batch (Diagnostics_RecordFormIDTraces)
+struct FormIDTraceRow
+{
+    uint32_t originalFormID;
+    uint32_t localKey;
+    uint32_t virtualFormID;
+    FormIDTraceReason reason;
+};
+
+// Record a module's traces under one lock (the form-map builders)
+void Diagnostics_RecordFormIDTraces(
+    PluginModuleId moduleId,
+    bool isESL,
+    const std::string& dummySlot,
+    const std::vector<FormIDTraceRow>& rows
+);
+
+// Record a FormID remap explanation by plugin name and free-form reason
 void Diagnostics_RecordFormIDTrace(
     const std::string& pluginName,
     uint32_t originalFormID,
@@ -104,8 +172,26 @@ void Diagnostics_RecordFormIDTrace(
 // Query API (used by console commands)
 // ------------------------------------------------------------
 
-// Query a FormID remap trace
+// Materialize the name -> summary view from the counter shards
+// (only modules with at least one non-zero counter, in ID order)
+std::vector<PluginDiagnosticsSummary> Diagnostics_GetPluginSummaries();
+
+// Query a FormID remap trace (binary search over the sorted FormID column)
 FormIDTraceResult Diagnostics_QueryFormID(uint32_t formID);
 
-// Dump all diagnostics to file (called at finalize)
+// All recorded traces for one plugin, in FormID order (per-module range index)
+std::vector<FormIDTraceResult> Diagnostics_QueryPluginTraces(const std::string& pluginName);
+
+// Number of recorded FormID traces
+std::size_t Diagnostics_GetFormIDTraceCount();
+
+// Dump all diagnostics to file synchronously (text and/or JSON Lines,
+// per sDiagnosticsFormat). Waits for any background report first.
 void Diagnostics_DumpToFile();
+
+// Snapshot diagnostics state and write the report on a worker thread.
+// Returns false if no thread could be started (report was written inline).
+bool Diagnostics_StartReportAsync();
+
+// Block until a background report (if any) has been written
+void Diagnostics_WaitForReport();
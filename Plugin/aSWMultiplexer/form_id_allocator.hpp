@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// FormIdAllocator — object-ID allocator for one dummy plugin
+//
+// Tracks which of a dummy plugin's 24-bit object IDs are taken with one
+// occupancy bit per ID (2^24 bits = 2 MB, allocated on first use). IDs
+// below kFirstId are reserved by the engine and never handed out.
+//
+// AllocateRun() packs a module's records into the lowest free IDs, all or
+// nothing, so a module never straddles two dummy plugins: when the slot is
+// too full the caller moves the whole module to the next slot. Given the
+// same modules in the same order it always produces the same IDs, which is
+// what lets csvbuilder precompute the result (form_tables.bin).
+//
+// Shared by both projects, so this header has no dependencies beyond the
+// C++ library. Not thread-safe; use one allocator per slot.
+// ============================================================================
+
+class FormIdAllocator
+{
+public:
+    static constexpr std::uint32_t kFirstId = 0x000800u;
+    static constexpr std::uint32_t kIdLimit = 0x1000000u;
+    static constexpr std::uint32_t kCapacity = kIdLimit - kFirstId;
+
+    std::uint32_t Used() const { return m_used; }
+    std::uint32_t Free() const { return kCapacity - m_used; }
+
+    bool IsTaken(std::uint32_t id) const
+    {
+        if (id < kFirstId || id >= kIdLimit || m_bits.empty())
+            return false;
+        return (m_bits[id >> 6] >> (id & 63)) & 1u;
+    }
+
+    // Marks one specific ID taken. False if it is reserved, out of range or
+    // already taken (i.e. two owners would collide).
+    bool Reserve(std::uint32_t id)
+    {
+        if (id < kFirstId || id >= kIdLimit || IsTaken(id))
+            return false;
+        Take(id);
+        return true;
+    }
+
+    // Appends 'count' free IDs in ascending order to outIds, lowest first.
+    // Takes nothing and returns false if fewer than 'count' are free.
+    bool AllocateRun(std::size_t count, std::vector<std::uint32_t>& outIds)
+    {
+        if (count > Free())
+            return false;
+
+        outIds.reserve(outIds.size() + count);
+
+        std::uint32_t word = m_cursor >> 6;
+        while (count > 0)
+        {
+            std::uint64_t free = ~Word(word);
+            if (word == (kFirstId >> 6))
+                free &= ~0ull << (kFirstId & 63);
+
+            while (free != 0 && count > 0)
+            {
+                const std::uint32_t id = (word << 6) | LowestBit(free);
+                free &= free - 1;
+                Take(id);
+                outIds.push_back(id);
+                --count;
+            }
+
+            if (count > 0)
+                ++word;
+        }
+
+        // Everything below the last word handed out is full
+        m_cursor = word << 6;
+        return true;
+    }
+
+    void Clear()
+    {
+        m_bits.clear();
+        m_bits.shrink_to_fit();
+        m_used = 0;
+        m_cursor = kFirstId;
+    }
+
+private:
+    static constexpr std::size_t kWords = kIdLimit / 64;
+
+    std::uint64_t Word(std::uint32_t w) const { return m_bits.empty() ? 0 : m_bits[w]; }
+
+    void Take(std::uint32_t id)
+    {
+        if (m_bits.empty())
+            m_bits.assign(kWords, 0);
+        m_bits[id >> 6] |= 1ull << (id & 63);
+        ++m_used;
+    }
+
+    // Index of the lowest set bit (v != 0), de Bruijn multiply
+    static std::uint32_t LowestBit(std::uint64_t v)
+    {
+        static constexpr std::uint8_t kTable[64] = {
+             0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+            62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+            63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+            46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+        };
+        return kTable[((v & (0 - v)) * 0x03F79D71B4CB0A89ull) >> 58];
+    }
+
+    std::vector<std::uint64_t> m_bits;      // empty until the first ID is taken
+    std::uint32_t m_used = 0;
+    std::uint32_t m_cursor = kFirstId;      // no free ID below this word
+};
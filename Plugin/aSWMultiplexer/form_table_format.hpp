@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ============================================================================
+// form_tables.bin — precomputed FormID remap tables
+//
+// Written by csvbuilder with one table per CSV dummy slot; read by the
+// plugin in place of build_form_maps(). Shared by both projects, so this
+// header has no dependencies beyond the C++ library.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//
+//   FormTableHeader
+//   FormTableSlot[slotCount]           CSV row order; each owns a module range
+//   FormTableModule[moduleCount]       CSV "Mods" order within the slot
+//   FormTableEntry[entryCount]         each module owns a range, sorted by key
+//   u32[refCount]                      LVLI entry FormIDs; each module owns a
+//                                      range, in its entries' order
+//   char[nameBlobSize]                 NUL-terminated module names
+//
+// Each module records the size and mtime of the plugin file it was built
+// from; the plugin only uses a slot's table when every fingerprint, the
+// module order and the fileIndex still match what it loaded.
+//
+// Entries also carry what inject_records needs (record type, and the LVLO
+// FormIDs of LVLI records), so a module filled from the table is injected
+// without scanning its plugin. csvbuilder does not inflate payloads: a
+// module with a compressed LVLI record is flagged kFormTableModuleScanRecords
+// and injection scans that plugin as before.
+//
+// Targets are allocated with FormIdAllocator (form_id_allocator.hpp): each
+// module's sorted local keys take the lowest free object IDs of its slot,
+// modules in slot order. A slot whose modules do not all fit is left out.
+// ============================================================================
+
+constexpr char          kFormTableMagic[4] = { 'M', 'X', 'F', 'T' };
+constexpr std::uint32_t kFormTableVersion = 4;
+constexpr const char*   kFormTableFileName = "form_tables.bin";
+
+// Multi-slot layout: CSV dummy slot k (of slotCount) is loaded at
+// base + k. If that would run past kMaxDummyFileIndex the base is lowered
+// so the whole block still fits below the ESL (0xFE) index. This is the
+// expected layout only: the plugin compares it with the real load order
+// once data is loaded and refuses slots that do not match.
+constexpr std::uint32_t kMaxDummyFileIndex = 0xFD;
+
+inline std::uint8_t DummySlotBaseFileIndex(std::uint8_t base, std::size_t slotCount)
+{
+    if (slotCount == 0 || base + slotCount - 1 <= kMaxDummyFileIndex)
+        return base;
+    return slotCount > kMaxDummyFileIndex + 1 ? 0 : static_cast<std::uint8_t>(kMaxDummyFileIndex + 1 - slotCount);
+}
+
+inline std::uint8_t DummySlotFileIndex(std::uint8_t base, std::size_t slotCount, std::size_t k)
+{
+    const std::size_t index = DummySlotBaseFileIndex(base, slotCount) + k;
+    return static_cast<std::uint8_t>(index < kMaxDummyFileIndex ? index : kMaxDummyFileIndex);
+}
+
+constexpr std::uint32_t kFormTableModuleESL = 0x1u;
+constexpr std::uint32_t kFormTableModuleWorldspace = 0x2u;   // skipped by build_form_maps: no entries
+constexpr std::uint32_t kFormTableModuleMissing = 0x4u;   // plugin file not found
+constexpr std::uint32_t kFormTableModuleScanRecords = 0x8u;   // LVLI refs not in the table: injection scans
+
+#pragma pack(push, 1)
+
+struct FormTableHeader
+{
+    char          magic[4];
+    std::uint32_t version;
+    std::uint64_t checksum;
+
+    std::uint32_t headerSize;
+    std::uint32_t fileSize;
+
+    std::uint32_t slotCount;
+    std::uint32_t slotOffset;
+    std::uint32_t moduleCount;
+    std::uint32_t moduleOffset;
+    std::uint32_t entryCount;
+    std::uint32_t entryOffset;
+    std::uint32_t refCount;
+    std::uint32_t refOffset;
+    std::uint32_t nameBlobOffset;
+    std::uint32_t nameBlobSize;
+};
+
+struct FormTableSlot
+{
+    std::uint8_t  fileIndex;
+    std::uint8_t  reserved[3];
+    std::uint32_t firstModule;
+    std::uint32_t moduleCount;
+    std::uint32_t reserved2;
+};
+
+struct FormTableModule
+{
+    std::uint32_t nameOffset;      // into the name blob
+    std::uint32_t nameLength;      // excluding the NUL
+    std::uint64_t pluginSize;      // std::filesystem::file_size
+    std::int64_t  pluginWriteTime; // last_write_time().time_since_epoch().count()
+    std::uint32_t flags;           // kFormTableModule*
+    std::uint32_t firstEntry;
+    std::uint32_t entryCount;
+    std::uint32_t firstRef;
+};
+
+struct FormTableEntry
+{
+    std::uint32_t localKey;
+    std::uint32_t target;
+    std::uint32_t type;            // record fourCC
+    std::uint32_t refCount;        // LVLI: LVLO FormIDs, next in the module's ref range
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FormTableHeader) == 64, "FormTableHeader layout changed");
+static_assert(sizeof(FormTableSlot) == 16, "FormTableSlot layout changed");
+static_assert(sizeof(FormTableModule) == 40, "FormTableModule layout changed");
+static_assert(sizeof(FormTableEntry) == 16, "FormTableEntry layout changed");
+
+inline std::uint64_t FormTableChecksum(const std::uint8_t* data, std::size_t size)
+{
+    constexpr std::size_t kSkipBegin = offsetof(FormTableHeader, checksum);
+    constexpr std::size_t kSkipEnd = kSkipBegin + sizeof(std::uint64_t);
+
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (i >= kSkipBegin && i < kSkipEnd)
+            continue;
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// ============================================================================
+// Offline replay of scan_plugin_records (scanner.cpp)
+//
+// Walks an in-memory plugin exactly as the runtime scanner walks the file:
+// TES4 header, then 24-byte top-level headers, skipping worldspace records
+// and anything that is not KYWD / WEAP / ARMO / LVLI. Calls
+// onRecord(formID, type, payload, payloadSize, compressed) for each
+// collected record. Keep the two walks in step.
+//
+// Compressed payloads are not inflated here, so a record whose payload the
+// runtime fails to inflate still gets a table entry (and is injected).
+// ============================================================================
+
+struct FormTableScan
+{
+    bool valid = false;           // TES4 header present
+    bool isESL = false;
+    bool containsWorldspace = false;
+};
+
+template <class OnRecord>
+FormTableScan FormTableScanPlugin(const std::uint8_t* data, std::size_t size, OnRecord&& onRecord)
+{
+    constexpr std::size_t kHeaderSize = 24;
+    constexpr std::uint32_t kESLFlag = 0x00000002u;
+    constexpr std::uint32_t kCompressedFlag = 0x00040000u;
+
+    auto fourcc = [](const char* s) {
+        return static_cast<std::uint32_t>(static_cast<unsigned char>(s[0])) |
+            (static_cast<std::uint32_t>(static_cast<unsigned char>(s[1])) << 8) |
+            (static_cast<std::uint32_t>(static_cast<unsigned char>(s[2])) << 16) |
+            (static_cast<std::uint32_t>(static_cast<unsigned char>(s[3])) << 24);
+    };
+    auto u32 = [data](std::size_t at) {
+        std::uint32_t v;
+        std::memcpy(&v, data + at, sizeof(v));
+        return v;
+    };
+
+    FormTableScan scan;
+    if (size < kHeaderSize || u32(0) != fourcc("TES4"))
+        return scan;
+
+    scan.valid = true;
+    scan.isESL = (u32(8) & kESLFlag) != 0;
+
+    const std::uint32_t kKYWD = fourcc("KYWD"), kWEAP = fourcc("WEAP");
+    const std::uint32_t kARMO = fourcc("ARMO"), kLVLI = fourcc("LVLI");
+    const std::uint32_t kWRLD = fourcc("WRLD"), kCELL = fourcc("CELL"), kLAND = fourcc("LAND");
+    const std::uint32_t kNAVM = fourcc("NAVM"), kREFR = fourcc("REFR"), kACHR = fourcc("ACHR");
+
+    std::uint64_t pos = kHeaderSize + static_cast<std::uint64_t>(u32(4));
+
+    while (pos + kHeaderSize <= size)
+    {
+        const std::size_t at = static_cast<std::size_t>(pos);
+        const std::uint32_t sig = u32(at);
+        const std::uint32_t dataSize = u32(at + 4);
+        const std::uint32_t formID = u32(at + 12);
+        pos += kHeaderSize;
+
+        if (dataSize == 0)
+            continue;
+
+        if (sig == kWRLD || sig == kCELL || sig == kLAND ||
+            sig == kNAVM || sig == kREFR || sig == kACHR)
+        {
+            scan.containsWorldspace = true;
+        }
+        else if (sig == kKYWD || sig == kWEAP || sig == kARMO || sig == kLVLI)
+        {
+            if (pos + dataSize > size)
+                break;   // truncated payload ends the runtime scan too
+            onRecord(formID, sig, data + static_cast<std::size_t>(pos), dataSize,
+                (u32(at + 8) & kCompressedFlag) != 0);
+        }
+
+        pos += dataSize;
+    }
+
+    return scan;
+}
+
+// LVLO FormIDs of an uncompressed LVLI payload, as the scanner's
+// parse_lvli_subrecord reads them (FormID first, entries under 12 bytes
+// ignored). Calls onRef(formID) in payload order.
+template <class OnRef>
+void FormTableForEachLvliRef(const std::uint8_t* payload, std::size_t size, OnRef&& onRef)
+{
+    constexpr std::size_t kSubHeaderSize = 6;   // u32 type | u16 size
+    const std::uint32_t kLVLO = 0x4F4C564Cu;    // 'LVLO'
+
+    std::size_t offset = 0;
+    while (offset + kSubHeaderSize <= size)
+    {
+        std::uint32_t type;
+        std::uint16_t dataSize;
+        std::memcpy(&type, payload + offset, sizeof(type));
+        std::memcpy(&dataSize, payload + offset + 4, sizeof(dataSize));
+        offset += kSubHeaderSize;
+
+        if (offset + dataSize > size)
+            break;
+
+        if (type == kLVLO && dataSize >= 12) {
+            std::uint32_t formID;
+            std::memcpy(&formID, payload + offset, sizeof(formID));
+            onRef(formID);
+        }
+        offset += dataSize;
+    }
+}
@@ -0,0 +1,228 @@
+#include "pch.h"
+#include "form_tables.hpp"
+#include "scanner.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Validation helpers
+// ============================================================================
+
+static bool SectionFits(std::uint64_t fileSize, std::uint32_t offset, std::uint32_t count, std::size_t elemSize)
+{
+    if (offset % 4 != 0)
+        return false;
+    const std::uint64_t end = static_cast<std::uint64_t>(offset) + static_cast<std::uint64_t>(count) * elemSize;
+    return end <= fileSize;
+}
+
+// Compares a plugin on disk against the fingerprint the table was built from
+static bool PluginMatches(const std::string& moduleName, const FormTableModule& rec)
+{
+    const std::string path = find_plugin_path(moduleName);
+    if (path.empty())
+        return (rec.flags & kFormTableModuleMissing) != 0;
+    if (rec.flags & kFormTableModuleMissing)
+        return false;
+
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec || size != rec.pluginSize)
+        return false;
+
+    const auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return false;
+
+    return static_cast<std::int64_t>(writeTime.time_since_epoch().count()) == rec.pluginWriteTime;
+}
+
+// ============================================================================
+// FormTables
+// ============================================================================
+
+bool FormTables::Open(const std::string& path, std::string& outReason)
+{
+    m_header = nullptr;
+
+    if (!m_file.Open(path)) {
+        outReason = "not found";
+        return false;
+    }
+
+    const std::uint8_t* data = m_file.Data();
+    const std::size_t size = m_file.Size();
+
+    auto fail = [&](const char* reason) {
+        outReason = reason;
+        m_file.Close();
+        return false;
+    };
+
+    if (size < sizeof(FormTableHeader))
+        return fail("truncated header");
+
+    const FormTableHeader* h = reinterpret_cast<const FormTableHeader*>(data);
+
+    if (std::memcmp(h->magic, kFormTableMagic, sizeof(h->magic)) != 0)
+        return fail("bad magic");
+    if (h->version != kFormTableVersion)
+        return fail("unsupported version");
+    if (h->headerSize != sizeof(FormTableHeader) || h->fileSize != size)
+        return fail("size mismatch");
+    if (FormTableChecksum(data, size) != h->checksum)
+        return fail("checksum mismatch");
+
+    if (!SectionFits(size, h->slotOffset, h->slotCount, sizeof(FormTableSlot)) ||
+        !SectionFits(size, h->moduleOffset, h->moduleCount, sizeof(FormTableModule)) ||
+        !SectionFits(size, h->entryOffset, h->entryCount, sizeof(FormTableEntry)) ||
+        !SectionFits(size, h->refOffset, h->refCount, sizeof(std::uint32_t)) ||
+        !SectionFits(size, h->nameBlobOffset, h->nameBlobSize, 1))
+        return fail("section out of bounds");
+
+    const FormTableSlot* slots = reinterpret_cast<const FormTableSlot*>(data + h->slotOffset);
+    const FormTableModule* modules = reinterpret_cast<const FormTableModule*>(data + h->moduleOffset);
+
+    for (std::uint32_t i = 0; i < h->slotCount; ++i)
+        if (static_cast<std::uint64_t>(slots[i].firstModule) + slots[i].moduleCount > h->moduleCount)
+            return fail("bad slot entry");
+
+    for (std::uint32_t i = 0; i < h->moduleCount; ++i)
+        if (static_cast<std::uint64_t>(modules[i].nameOffset) + modules[i].nameLength >= h->nameBlobSize ||
+            static_cast<std::uint64_t>(modules[i].firstEntry) + modules[i].entryCount > h->entryCount)
+            return fail("bad module entry");
+
+    m_header = h;
+    m_slots = slots;
+    m_modules = modules;
+    m_entries = reinterpret_cast<const FormTableEntry*>(data + h->entryOffset);
+    m_refs = reinterpret_cast<const std::uint32_t*>(data + h->refOffset);
+    m_names = reinterpret_cast<const char*>(data + h->nameBlobOffset);
+    return true;
+}
+
+bool FormTables::Apply(SlotDescriptor& slot, FormIdAllocator& ids, const FormIdLedger& ledger, std::string& outReason) const
+{
+    if (!m_header) {
+        outReason = "not loaded";
+        return false;
+    }
+
+    const FormTableSlot* table = nullptr;
+    for (std::uint32_t i = 0; i < m_header->slotCount && !table; ++i)
+        if (m_slots[i].fileIndex == slot.fileIndex)
+            table = &m_slots[i];
+
+    if (!table) {
+        outReason = "no table for this fileIndex";
+        return false;
+    }
+    if (table->moduleCount != slot.modules.size()) {
+        outReason = "stale (module list differs)";
+        return false;
+    }
+
+    const FormTableModule* modules = m_modules + table->firstModule;
+
+    for (std::uint32_t i = 0; i < table->moduleCount; ++i)
+    {
+        const FormTableModule& rec = modules[i];
+        const ModuleDescriptor& m = slot.modules[i];
+
+        if (rec.nameLength != m.name.size() ||
+            _strnicmp(m_names + rec.nameOffset, m.name.c_str(), rec.nameLength) != 0) {
+            outReason = "stale (module list differs at '" + m.name + "')";
+            return false;
+        }
+        if (!PluginMatches(m.name, rec)) {
+            outReason = "stale ('" + m.name + "' changed since csvbuilder ran)";
+            return false;
+        }
+        if (((rec.flags & kFormTableModuleESL) != 0) != m.isESL) {
+            outReason = "stale ('" + m.name + "' ESL flag differs)";
+            return false;
+        }
+        if (((rec.flags & kFormTableModuleWorldspace) != 0) != m.containsWorldspace) {
+            outReason = "stale ('" + m.name + "' worldspace flag differs)";
+            return false;
+        }
+    }
+
+    // Every module matches: build the maps build_form_maps would produce,
+    // and only hand them to the slot once every entry has been checked
+    std::vector<std::unordered_map<std::uint32_t, std::uint32_t>> maps(table->moduleCount);
+    const std::uint32_t dummy = ledger.Dummy(slot.dummyName);
+
+    for (std::uint32_t i = 0; i < table->moduleCount; ++i)
+    {
+        const FormTableModule& rec = modules[i];
+        const FormIdLedger::KeyMap* known = ledger.Module(slot.modules[i].name);
+        maps[i].reserve(rec.entryCount);
+
+        const FormTableEntry* e = m_entries + rec.firstEntry;
+        for (std::uint32_t k = 0; k < rec.entryCount; ++k)
+        {
+            std::uint32_t ledgered = 0;
+            const bool inLedger = FormIdLedger::Find(known, e[k].localKey, dummy, ledgered);
+
+            if ((e[k].target >> 24) != slot.fileIndex ||
+                (inLedger ? ledgered != (e[k].target & 0x00FFFFFFu) : !ids.Reserve(e[k].target & 0x00FFFFFFu)))
+            {
+                ids.Clear();
+
+                char target[9];
+                std::snprintf(target, sizeof(target), "%08X", e[k].target);
+                outReason = inLedger && (e[k].target >> 24) == slot.fileIndex ?
+                    std::string("stale (target ") + target + " differs from " + kFormIdLedgerFileName + ")" :
+                    std::string("corrupt (target ") + target + " outside the slot or taken twice)";
+                return false;
+            }
+            maps[i].emplace(e[k].localKey, e[k].target);
+        }
+    }
+
+    for (std::uint32_t i = 0; i < table->moduleCount; ++i) {
+        slot.modules[i].formIdMap = std::move(maps[i]);
+        slot.modules[i].formTableModule = table->firstModule + i;
+    }
+
+    return true;
+}
+
+bool FormTables::Records(std::uint32_t module, std::vector<RawRecord>& out) const
+{
+    if (!m_header || module >= m_header->moduleCount)
+        return false;
+
+    const FormTableModule& rec = m_modules[module];
+    if (rec.flags & kFormTableModuleScanRecords)
+        return false;
+
+    const FormTableEntry* e = m_entries + rec.firstEntry;
+    std::uint64_t ref = rec.firstRef;
+
+    out.clear();
+    out.resize(rec.entryCount);
+    for (std::uint32_t k = 0; k < rec.entryCount; ++k)
+    {
+        if (ref + e[k].refCount > m_header->refCount) {
+            out.clear();
+            return false;
+        }
+
+        RawRecord& r = out[k];
+        r.localFormID = e[k].localKey;
+        r.type = e[k].type;
+        r.payload.lvliEntries.resize(e[k].refCount);
+        for (std::uint32_t j = 0; j < e[k].refCount; ++j)
+            r.payload.lvliEntries[j].formID = m_refs[ref + j];
+        ref += e[k].refCount;
+    }
+
+    return true;
+}
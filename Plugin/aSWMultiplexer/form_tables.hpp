@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "form_table_format.hpp"
+#include "form_id_allocator.hpp"
+#include "formid_ledger.hpp"
+#include "mapping.hpp"   // SlotDescriptor
+#include "records.hpp"   // RawRecord
+
+// ============================================================================
+// Precomputed form maps (form_tables.bin, see form_table_format.hpp)
+//
+// Open() maps the file once and validates header, checksum and bounds.
+// Apply() then fills a dummy slot's formIdMaps from the table csvbuilder
+// wrote for the same fileIndex, provided the module order and every plugin's
+// size, mtime, ESL and worldspace flags still match; otherwise it reports
+// why, leaves the slot untouched and returns false so build_form_maps()
+// runs for that slot.
+//
+// Object IDs the ledger holds for the slot's dummy plugin must match (already
+// reserved in 'ids'); every other target is reserved in 'ids', so a table
+// that would hand one ID out twice is refused. A refusal at that point
+// clears 'ids'.
+//
+// Apply() is const and may run for several slots concurrently. Call it after
+// scan_plugin_metadata() (the ESL and worldspace flags are compared).
+// ============================================================================
+
+class FormTables
+{
+public:
+    bool Open(const std::string& path, std::string& outReason);
+    bool IsOpen() const { return m_header != nullptr; }
+
+    bool Apply(SlotDescriptor& slot, FormIdAllocator& ids, const FormIdLedger& ledger, std::string& outReason) const;
+
+    // The records inject_records needs for a module Apply filled (index =
+    // ModuleDescriptor::formTableModule), in local-key order. False if the
+    // table does not carry them (kFormTableModuleScanRecords) or they are
+    // out of bounds; scan the plugin then.
+    bool Records(std::uint32_t module, std::vector<RawRecord>& out) const;
+
+private:
+    MappedFile m_file;
+    const FormTableHeader* m_header = nullptr;
+    const FormTableSlot* m_slots = nullptr;
+    const FormTableModule* m_modules = nullptr;
+    const FormTableEntry* m_entries = nullptr;
+    const std::uint32_t* m_refs = nullptr;
+    const char* m_names = nullptr;
+};
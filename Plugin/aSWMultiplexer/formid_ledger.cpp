@@ -0,0 +1,253 @@
+#include "pch.h"
+#include "formid_ledger.hpp"
+#include "mapped_file.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+// Superseded entries are only compacted away once they outnumber the live
+// ones and the file is big enough for it to matter
+static constexpr std::size_t kRewriteMinEntries = 4096;
+
+static std::string FoldName(const std::string& name)
+{
+    std::string out = name;
+    for (char& c : out)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+static bool WriteAll(const std::string& path, const std::vector<std::uint8_t>& bytes, std::ios::openmode mode)
+{
+    std::ofstream out(path, std::ios::binary | mode);
+    if (!out.is_open())
+        return false;
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+// ============================================================================
+// FormIdLedger
+// ============================================================================
+
+void FormIdLedger::Load(const std::string& path)
+{
+    m_path = path;
+    m_modules.clear();
+    m_dummies.clear();
+    m_dummyIds.clear();
+    m_live = 0;
+    m_fileEntries = 0;
+    m_rewrite = true;   // until a valid file has been read
+
+    MappedFile file;
+    if (!file.Open(path)) {
+        logf("FormIdLedger: %s not found - starting a new ledger.", path.c_str());
+        return;
+    }
+
+    const std::size_t intact = FormIdLedgerParse(file.Data(), file.Size(),
+        [this](std::string_view module, std::string_view dummy, std::uint32_t localKey, std::uint32_t objectID) {
+            KeyMap& keys = m_modules[std::string(module)];
+            if (keys.insert_or_assign(localKey, Assignment{ InternDummy(dummy), objectID }).second)
+                ++m_live;
+            ++m_fileEntries;
+        });
+
+    if (intact == 0) {
+        logf("FormIdLedger: %s has a bad header - starting a new ledger.", path.c_str());
+        return;
+    }
+
+    if (intact < file.Size())
+        logf("WARNING: FormIdLedger: dropped %zu damaged trailing bytes of %s.",
+            file.Size() - intact, path.c_str());
+    else
+        m_rewrite = false;
+
+    logf("FormIdLedger: loaded %zu assignments for %zu modules in %zu dummy plugins.",
+        m_live, m_modules.size(), m_dummies.size());
+}
+
+std::uint32_t FormIdLedger::InternDummy(std::string_view folded)
+{
+    std::unordered_map<std::string, std::uint32_t>::iterator it = m_dummyIds.find(std::string(folded));
+    if (it != m_dummyIds.end())
+        return it->second;
+
+    const std::uint32_t id = static_cast<std::uint32_t>(m_dummies.size());
+    m_dummies.emplace_back(folded);
+    m_dummyIds.emplace(m_dummies.back(), id);
+    return id;
+}
+
+const FormIdLedger::KeyMap* FormIdLedger::Module(const std::string& name) const
+{
+    std::unordered_map<std::string, KeyMap>::const_iterator it = m_modules.find(FoldName(name));
+    return it != m_modules.end() ? &it->second : nullptr;
+}
+
+std::uint32_t FormIdLedger::Dummy(const std::string& dummyName) const
+{
+    std::unordered_map<std::string, std::uint32_t>::const_iterator it = m_dummyIds.find(FoldName(dummyName));
+    return it != m_dummyIds.end() ? it->second : kNoDummy;
+}
+
+bool FormIdLedger::Find(const KeyMap* module, std::uint32_t localKey, std::uint32_t dummy, std::uint32_t& outObjectID)
+{
+    if (!module || dummy == kNoDummy)
+        return false;
+
+    KeyMap::const_iterator it = module->find(localKey);
+    if (it == module->end() || it->second.dummy != dummy)
+        return false;
+
+    outObjectID = it->second.objectID;
+    return true;
+}
+
+void FormIdLedger::ReserveSlot(const std::string& dummyName, FormIdAllocator& ids) const
+{
+    const std::uint32_t dummy = Dummy(dummyName);
+    if (dummy == kNoDummy)
+        return;
+
+    for (const auto& module : m_modules)
+        for (const auto& entry : module.second)
+            if (entry.second.dummy == dummy)
+                ids.Reserve(entry.second.objectID);
+}
+
+void FormIdLedger::RecordSlot(const SlotDescriptor& slot)
+{
+    const std::uint32_t dummy = Dummy(slot.dummyName);
+    std::vector<PendingBlock> fresh;
+
+    for (const ModuleDescriptor& m : slot.modules)
+    {
+        const KeyMap* known = Module(m.name);
+
+        std::vector<FormIdLedgerEntry> entries;
+        for (std::size_t i = 0; i < m.formIds.Size(); ++i)
+        {
+            const FormIdLedgerEntry e{ m.formIds.KeyAt(i), m.formIds.ValueAt(i) & 0x00FFFFFFu };
+            std::uint32_t objectID = 0;
+            if (Find(known, e.localKey, dummy, objectID) && objectID == e.objectID)
+                continue;
+            entries.push_back(e);
+        }
+
+        if (entries.empty())
+            continue;
+
+        std::sort(entries.begin(), entries.end(),
+            [](const FormIdLedgerEntry& a, const FormIdLedgerEntry& b) { return a.localKey < b.localKey; });
+        fresh.push_back(PendingBlock{ FoldName(m.name), FoldName(slot.dummyName), std::move(entries) });
+    }
+
+    if (fresh.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    for (PendingBlock& block : fresh)
+        m_pending.push_back(std::move(block));
+}
+
+bool FormIdLedger::Flush()
+{
+    std::vector<PendingBlock> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        pending.swap(m_pending);
+    }
+
+    std::size_t added = 0;
+    for (const PendingBlock& block : pending)
+    {
+        KeyMap& keys = m_modules[block.module];
+        const std::uint32_t dummy = InternDummy(block.dummy);
+        for (const FormIdLedgerEntry& e : block.entries)
+            if (keys.insert_or_assign(e.localKey, Assignment{ dummy, e.objectID }).second)
+                ++m_live;
+        m_fileEntries += block.entries.size();
+        added += block.entries.size();
+    }
+
+    if (!m_rewrite && m_fileEntries > kRewriteMinEntries && m_fileEntries > 2 * m_live)
+        m_rewrite = true;
+
+    if (!m_rewrite)
+    {
+        if (pending.empty())
+            return true;
+
+        std::vector<std::uint8_t> bytes;
+        for (const PendingBlock& block : pending)
+            FormIdLedgerAppendBlock(bytes, block.module, block.dummy, block.entries.data(), block.entries.size());
+
+        if (!WriteAll(m_path, bytes, std::ios::app)) {
+            logf("ERROR: FormIdLedger: could not append to %s.", m_path.c_str());
+            return false;
+        }
+
+        logf("FormIdLedger: appended %zu new assignments (%zu total).", added, m_live);
+        return true;
+    }
+
+    // Rewrite: one block per module and dummy plugin, sorted, via a temporary file
+    std::vector<std::string> names;
+    names.reserve(m_modules.size());
+    for (const auto& module : m_modules)
+        names.push_back(module.first);
+    std::sort(names.begin(), names.end());
+
+    std::vector<std::uint8_t> bytes;
+    FormIdLedgerWriteHeader(bytes);
+
+    std::vector<std::pair<std::uint32_t, FormIdLedgerEntry>> entries;   // dummy, entry
+    std::vector<FormIdLedgerEntry> block;
+    for (const std::string& name : names)
+    {
+        const KeyMap& keys = m_modules[name];
+        entries.clear();
+        entries.reserve(keys.size());
+        for (const auto& kv : keys)
+            entries.emplace_back(kv.second.dummy, FormIdLedgerEntry{ kv.first, kv.second.objectID });
+        std::sort(entries.begin(), entries.end(),
+            [](const std::pair<std::uint32_t, FormIdLedgerEntry>& a, const std::pair<std::uint32_t, FormIdLedgerEntry>& b) {
+                return a.first != b.first ? a.first < b.first : a.second.localKey < b.second.localKey;
+            });
+
+        for (std::size_t i = 0; i < entries.size();)
+        {
+            const std::uint32_t dummy = entries[i].first;
+            block.clear();
+            for (; i < entries.size() && entries[i].first == dummy; ++i)
+                block.push_back(entries[i].second);
+            FormIdLedgerAppendBlock(bytes, name, m_dummies[dummy], block.data(), block.size());
+        }
+    }
+
+    const std::string tmpPath = m_path + ".tmp";
+    std::error_code ec;
+    if (!WriteAll(tmpPath, bytes, std::ios::trunc)) {
+        logf("ERROR: FormIdLedger: could not write %s.", tmpPath.c_str());
+        return false;
+    }
+    std::filesystem::rename(tmpPath, m_path, ec);
+    if (ec) {
+        logf("ERROR: FormIdLedger: could not replace %s (%s).", m_path.c_str(), ec.message().c_str());
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+
+    m_fileEntries = m_live;
+    m_rewrite = false;
+
+    logf("FormIdLedger: wrote %s (%zu assignments, %zu new).", m_path.c_str(), m_live, added);
+    return true;
+}
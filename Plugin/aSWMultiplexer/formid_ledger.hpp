@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "formid_ledger_format.hpp"
+#include "form_id_allocator.hpp"
+#include "mapping.hpp"   // SlotDescriptor
+
+// ============================================================================
+// FormIdLedger
+//
+// In-memory view of formid_ledger.bin (see formid_ledger_format.hpp). The
+// form-map builders look a record up here before allocating, so existing
+// assignments stay fixed and only new records take fresh IDs.
+//
+// Load() and Flush() run on the pipeline thread. During the parallel slot
+// phase the lookups are read-only and RecordSlot() only queues, so slots
+// may share one ledger.
+// ============================================================================
+
+class FormIdLedger
+{
+public:
+    static constexpr std::uint32_t kNoDummy = 0xFFFFFFFFu;
+
+    // Where a record was placed: a dummy plugin (see Dummy()) and an object
+    // ID in it. The load index is not stored.
+    struct Assignment
+    {
+        std::uint32_t dummy;
+        std::uint32_t objectID;
+    };
+
+    using KeyMap = std::unordered_map<std::uint32_t, Assignment>;
+
+    // A missing file is an empty ledger. A damaged tail is dropped and the
+    // file rewritten by the next Flush().
+    void Load(const std::string& path);
+
+    std::size_t Size() const { return m_live; }
+
+    // Previous assignments of a module (any case), or nullptr
+    const KeyMap* Module(const std::string& name) const;
+
+    // Id of a dummy plugin (any case) in the ledger, or kNoDummy
+    std::uint32_t Dummy(const std::string& dummyName) const;
+
+    // The module's object ID for localKey, if it was placed in dummy plugin 'dummy'
+    static bool Find(const KeyMap* module, std::uint32_t localKey, std::uint32_t dummy, std::uint32_t& outObjectID);
+
+    // Marks every object ID assigned in the dummy plugin taken, including
+    // those of modules that are not loaded this session
+    void ReserveSlot(const std::string& dummyName, FormIdAllocator& ids) const;
+
+    // Queues the slot's (sealed) form-map entries the ledger does not hold yet
+    void RecordSlot(const SlotDescriptor& slot);
+
+    // Appends the queued entries, or rewrites the file when it is damaged or
+    // mostly superseded. Returns false if the file could not be written.
+    bool Flush();
+
+private:
+    struct PendingBlock
+    {
+        std::string module;   // folded
+        std::string dummy;    // folded
+        std::vector<FormIdLedgerEntry> entries;
+    };
+
+    std::uint32_t InternDummy(std::string_view folded);
+
+    std::string m_path;
+    std::unordered_map<std::string, KeyMap> m_modules;   // folded name
+    std::vector<std::string> m_dummies;                  // Assignment::dummy -> folded name
+    std::unordered_map<std::string, std::uint32_t> m_dummyIds;
+    std::size_t m_live = 0;            // entries in m_modules
+    std::size_t m_fileEntries = 0;     // entries in the file, superseded ones included
+    bool m_rewrite = false;
+
+    std::mutex m_pendingMutex;
+    std::vector<PendingBlock> m_pending;
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// formid_ledger.bin — persistent (module, local key) -> dummy-plugin ID assignments
+//
+// Appended to by the plugin whenever it hands out new dummy-plugin FormIDs;
+// read by the plugin and by csvbuilder before allocating, so a record keeps
+// the FormID it was first given (and saves stay valid) when the load order
+// or the CSV grouping changes. Shared by both projects, so this header has
+// no dependencies beyond the C++ library.
+//
+// Layout (little-endian, unaligned):
+//
+//   char[4] magic | u32 version
+//   block*        u16 nameLength | name (case-folded module name)
+//                 u16 dummyLength | dummy (case-folded dummy plugin name)
+//                 u32 count | count x (u32 localKey | u32 objectID)
+//                 u64 checksum (FNV-1a 64 over the block before it)
+//
+// Later blocks override earlier ones key by key. A block that is truncated
+// or fails its checksum ends the ledger (a torn append loses only itself).
+//
+// An assignment is a dummy plugin and a 24-bit object ID in it, never a
+// full FormID: the load index is added only when the FormID is composed,
+// so assignments survive the dummy plugins moving in the load order. It
+// only counts for the dummy plugin it names; a module that moved to
+// another dummy plugin gets fresh IDs there, which then override.
+// ============================================================================
+
+constexpr char          kFormIdLedgerMagic[4] = { 'M', 'X', 'F', 'L' };
+constexpr std::uint32_t kFormIdLedgerVersion = 1;
+constexpr const char*   kFormIdLedgerFileName = "formid_ledger.bin";
+constexpr std::size_t   kFormIdLedgerHeaderSize = 8;
+
+struct FormIdLedgerEntry
+{
+    std::uint32_t localKey;
+    std::uint32_t objectID;   // low 24 bits of the FormID in the dummy plugin
+};
+
+inline std::uint64_t FormIdLedgerChecksum(const std::uint8_t* data, std::size_t size)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+inline void FormIdLedgerWriteHeader(std::vector<std::uint8_t>& out)
+{
+    const std::uint32_t version = kFormIdLedgerVersion;
+    out.insert(out.end(), kFormIdLedgerMagic, kFormIdLedgerMagic + 4);
+    out.insert(out.end(), reinterpret_cast<const std::uint8_t*>(&version),
+        reinterpret_cast<const std::uint8_t*>(&version) + sizeof(version));
+}
+
+inline void FormIdLedgerAppendBlock(std::vector<std::uint8_t>& out,
+    std::string_view module,
+    std::string_view dummy,
+    const FormIdLedgerEntry* entries,
+    std::size_t count)
+{
+    auto put = [&out](const void* p, std::size_t n) {
+        const std::uint8_t* b = static_cast<const std::uint8_t*>(p);
+        out.insert(out.end(), b, b + n);
+    };
+
+    const std::size_t begin = out.size();
+    const std::uint16_t nameLength = static_cast<std::uint16_t>(module.size() < 0xFFFF ? module.size() : 0xFFFF);
+    const std::uint16_t dummyLength = static_cast<std::uint16_t>(dummy.size() < 0xFFFF ? dummy.size() : 0xFFFF);
+    const std::uint32_t n = static_cast<std::uint32_t>(count);
+
+    put(&nameLength, sizeof(nameLength));
+    put(module.data(), nameLength);
+    put(&dummyLength, sizeof(dummyLength));
+    put(dummy.data(), dummyLength);
+    put(&n, sizeof(n));
+    for (std::size_t i = 0; i < count; ++i) {
+        put(&entries[i].localKey, sizeof(std::uint32_t));
+        put(&entries[i].objectID, sizeof(std::uint32_t));
+    }
+
+    const std::uint64_t checksum = FormIdLedgerChecksum(out.data() + begin, out.size() - begin);
+    put(&checksum, sizeof(checksum));
+}
+
+// Calls onEntry(module, dummy, localKey, objectID) for every entry of
+// every intact block, in file order. Returns the size of the intact
+// prefix: 0 if the header is bad, size if the whole ledger is intact.
+template <class OnEntry>
+std::size_t FormIdLedgerParse(const std::uint8_t* data, std::size_t size, OnEntry&& onEntry)
+{
+    auto u32 = [data](std::size_t at) {
+        std::uint32_t v;
+        std::memcpy(&v, data + at, sizeof(v));
+        return v;
+    };
+
+    if (size < kFormIdLedgerHeaderSize ||
+        std::memcmp(data, kFormIdLedgerMagic, 4) != 0 ||
+        u32(4) != kFormIdLedgerVersion)
+        return 0;
+
+    std::size_t intact = kFormIdLedgerHeaderSize;
+    while (intact < size)
+    {
+        const std::size_t begin = intact;
+        std::size_t pos = begin;
+
+        std::uint16_t nameLength;
+        if (size - pos < sizeof(nameLength))
+            break;
+        std::memcpy(&nameLength, data + pos, sizeof(nameLength));
+        pos += sizeof(nameLength);
+
+        if (size - pos < static_cast<std::size_t>(nameLength) + 2)
+            break;
+        const std::string_view module(reinterpret_cast<const char*>(data + pos), nameLength);
+        pos += nameLength;
+
+        std::uint16_t dummyLength;
+        std::memcpy(&dummyLength, data + pos, sizeof(dummyLength));
+        pos += sizeof(dummyLength);
+
+        if (size - pos < static_cast<std::size_t>(dummyLength) + 4)
+            break;
+        const std::string_view dummy(reinterpret_cast<const char*>(data + pos), dummyLength);
+        pos += dummyLength;
+
+        const std::uint32_t count = u32(pos);
+        pos += 4;
+
+        if ((size - pos) / 8 < count || size - pos - static_cast<std::size_t>(count) * 8 < 8)
+            break;
+        const std::size_t entries = pos;
+        pos += static_cast<std::size_t>(count) * 8;
+
+        std::uint64_t checksum;
+        std::memcpy(&checksum, data + pos, sizeof(checksum));
+        if (FormIdLedgerChecksum(data + begin, pos - begin) != checksum)
+            break;
+        pos += sizeof(checksum);
+
+        for (std::uint32_t i = 0; i < count; ++i)
+            onEntry(module, dummy, u32(entries + i * 8), u32(entries + i * 8 + 4) & 0x00FFFFFFu);
+
+        intact = pos;
+    }
+
+    return intact;
+}
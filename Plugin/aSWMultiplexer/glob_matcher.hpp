@@ -0,0 +1,532 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// GlobMatcher
+//
+// A set of ASCII-case-insensitive glob patterns ('*' = any run of bytes,
+// '?' = any one byte, everything else literal) compiled into one DFA by
+// subset construction. Exact names and prefix rules ("SS2_*") become
+// shared trie paths; Matches() is one table lookup per byte of the name
+// and stops early once no pattern can match.
+//
+// Pathological rule sets whose DFA would exceed kMaxStates fall back to
+// matching each pattern in turn (Build() returns false so the caller can
+// log it).
+//
+// Build once, then Matches() is const and safe to call from many threads.
+// Shared by both projects (csvbuilder applies the same whitelist), so this
+// header has no dependencies beyond the C++ library.
+// ============================================================================
+
+class GlobMatcher
+{
+public:
+    static constexpr std::size_t kMaxStates = 1u << 16;
+
+    // Register a pattern (empty patterns are ignored)
+    void Add(std::string_view pattern);
+
+    // Compile the automaton. Add() after Build() requires another Build().
+    // False if it fell back to per-pattern matching.
+    bool Build();
+
+    bool Matches(std::string_view name) const;
+
+    std::size_t PatternCount() const { return m_patterns.size(); }
+    std::size_t StateCount() const { return m_stateCount; }
+
+private:
+    std::vector<std::string> m_patterns;     // folded
+
+    std::uint8_t m_classOf[256] = {};        // folded byte -> column (0 = in no pattern as a literal)
+    std::uint32_t m_classCount = 1;
+    std::uint32_t m_stateCount = 0;          // 0 = not built (or fell back)
+
+    std::vector<std::uint32_t> m_next;       // [state * m_classCount + class]; state 0 is dead
+    std::vector<std::uint8_t> m_accept;
+};
+
+// ============================================================================
+// protected_plugins.json reader
+//
+// Streams the file through a small JSON tokenizer (no whole-file copy)
+// and collects rule patterns: every object key and every array string that
+// looks like a plugin name or glob (contains '.', '*' or '?'). Keys starting
+// with '_' and the per-entry fields "protected", "injectable" and "reason"
+// are not rules; plain string values (e.g. a reason text) never are.
+//
+// Accepts both ["A.esp", "SS2_*.esp"] and { "A.esp": { "reason": "..." } }.
+// Returns false with a message (and offset) on malformed JSON.
+// ============================================================================
+
+bool ReadWhitelistPatterns(std::istream& in, std::vector<std::string>& outPatterns, std::string& outError);
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+namespace glob_detail
+{
+    inline std::uint8_t FoldByte(std::uint8_t c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<std::uint8_t>(c + ('a' - 'A')) : c;
+    }
+
+    // Reference matcher, used when the DFA would be too large
+    inline bool GlobMatchFolded(std::string_view pattern, std::string_view name)
+    {
+        std::size_t p = 0, n = 0;
+        std::size_t starP = std::string_view::npos, starN = 0;
+
+        while (n < name.size())
+        {
+            const std::uint8_t c = FoldByte(static_cast<std::uint8_t>(name[n]));
+
+            if (p < pattern.size() && (pattern[p] == '?' || static_cast<std::uint8_t>(pattern[p]) == c)) {
+                ++p;
+                ++n;
+            }
+            else if (p < pattern.size() && pattern[p] == '*') {
+                starP = p++;
+                starN = n;
+            }
+            else if (starP != std::string_view::npos) {
+                p = starP + 1;
+                n = ++starN;
+            }
+            else {
+                return false;
+            }
+        }
+
+        while (p < pattern.size() && pattern[p] == '*')
+            ++p;
+        return p == pattern.size();
+    }
+}
+
+// ============================================================================
+// GlobMatcher
+// ============================================================================
+
+inline void GlobMatcher::Add(std::string_view pattern)
+{
+    if (pattern.empty())
+        return;
+
+    std::string folded(pattern);
+    for (char& c : folded)
+        c = static_cast<char>(glob_detail::FoldByte(static_cast<std::uint8_t>(c)));
+
+    m_patterns.push_back(std::move(folded));
+}
+
+inline bool GlobMatcher::Build()
+{
+    m_next.clear();
+    m_accept.clear();
+    m_stateCount = 0;
+    m_classCount = 1;
+    std::fill(std::begin(m_classOf), std::end(m_classOf), std::uint8_t(0));
+
+    if (m_patterns.empty())
+        return true;
+
+    // Columns: one per literal byte (both cases share it), 0 for the rest
+    for (const std::string& pat : m_patterns) {
+        for (char ch : pat) {
+            const std::uint8_t c = static_cast<std::uint8_t>(ch);
+            if (ch == '*' || ch == '?' || m_classOf[c] != 0)
+                continue;
+            m_classOf[c] = static_cast<std::uint8_t>(m_classCount++);
+            if (c >= 'a' && c <= 'z')
+                m_classOf[c - ('a' - 'A')] = m_classOf[c];
+        }
+    }
+
+    // Column -> representative folded byte (0 = "any other byte")
+    std::vector<std::int32_t> classByte(m_classCount, -1);
+    for (int b = 0; b < 256; ++b) {
+        const std::uint8_t cls = m_classOf[b];
+        if (cls != 0 && classByte[cls] < 0)
+            classByte[cls] = glob_detail::FoldByte(static_cast<std::uint8_t>(b));
+    }
+
+    // NFA state = (pattern, position); flattened as base[pattern] + position
+    std::vector<std::uint32_t> base(m_patterns.size() + 1, 0);
+    for (std::size_t i = 0; i < m_patterns.size(); ++i)
+        base[i + 1] = base[i] + static_cast<std::uint32_t>(m_patterns[i].size() + 1);
+
+    std::vector<std::uint32_t> patternOf(base.back());
+    for (std::size_t i = 0; i < m_patterns.size(); ++i)
+        for (std::uint32_t s = base[i]; s < base[i + 1]; ++s)
+            patternOf[s] = static_cast<std::uint32_t>(i);
+
+    // A '*' at the current position may match nothing
+    auto closeOver = [&](std::vector<std::uint32_t>& set) {
+        for (std::size_t k = 0; k < set.size(); ++k) {
+            const std::uint32_t s = set[k];
+            const std::uint32_t pat = patternOf[s];
+            const std::uint32_t pos = s - base[pat];
+            if (pos < m_patterns[pat].size() && m_patterns[pat][pos] == '*')
+                set.push_back(s + 1);
+        }
+        std::sort(set.begin(), set.end());
+        set.erase(std::unique(set.begin(), set.end()), set.end());
+    };
+
+    auto isAccepting = [&](const std::vector<std::uint32_t>& set) {
+        for (std::uint32_t s : set) {
+            const std::uint32_t pat = patternOf[s];
+            if (s - base[pat] == m_patterns[pat].size())
+                return true;
+        }
+        return false;
+    };
+
+    std::map<std::vector<std::uint32_t>, std::uint32_t> ids;
+    std::vector<std::vector<std::uint32_t>> sets;
+
+    auto intern = [&](std::vector<std::uint32_t>&& set) -> std::uint32_t {
+        auto it = ids.find(set);
+        if (it != ids.end())
+            return it->second;
+        const std::uint32_t id = static_cast<std::uint32_t>(sets.size());
+        ids.emplace(set, id);
+        m_accept.push_back(isAccepting(set) ? 1 : 0);
+        m_next.resize(m_next.size() + m_classCount, 0);
+        sets.push_back(std::move(set));
+        return id;
+    };
+
+    intern({});                                   // 0: dead
+
+    std::vector<std::uint32_t> start;
+    for (std::size_t i = 0; i < m_patterns.size(); ++i)
+        start.push_back(base[i]);
+    closeOver(start);
+    intern(std::move(start));                     // 1: start
+
+    for (std::uint32_t d = 1; d < sets.size(); ++d)
+    {
+        if (sets.size() > kMaxStates) {
+            m_next.clear();
+            m_accept.clear();
+            m_stateCount = 0;
+            return false;
+        }
+
+        for (std::uint32_t cls = 0; cls < m_classCount; ++cls)
+        {
+            std::vector<std::uint32_t> next;
+            for (std::uint32_t s : sets[d]) {
+                const std::uint32_t pat = patternOf[s];
+                const std::uint32_t pos = s - base[pat];
+                if (pos == m_patterns[pat].size())
+                    continue;
+
+                const char t = m_patterns[pat][pos];
+                if (t == '*')
+                    next.push_back(s);
+                else if (t == '?' || (cls != 0 && static_cast<std::uint8_t>(t) == classByte[cls]))
+                    next.push_back(s + 1);
+            }
+            closeOver(next);
+
+            // intern() may grow m_next, so index after it returns
+            const std::uint32_t target = intern(std::move(next));
+            m_next[d * m_classCount + cls] = target;
+        }
+    }
+
+    m_stateCount = static_cast<std::uint32_t>(sets.size());
+    return true;
+}
+
+inline bool GlobMatcher::Matches(std::string_view name) const
+{
+    if (m_stateCount == 0)
+    {
+        for (const std::string& pat : m_patterns)
+            if (glob_detail::GlobMatchFolded(pat, name))
+                return true;
+        return false;
+    }
+
+    std::uint32_t state = 1;
+    for (char ch : name) {
+        state = m_next[state * m_classCount + m_classOf[static_cast<std::uint8_t>(ch)]];
+        if (state == 0)
+            return false;
+    }
+    return m_accept[state] != 0;
+}
+
+// ============================================================================
+// protected_plugins.json reader
+// ============================================================================
+
+namespace glob_detail
+{
+    class JsonPatternReader
+    {
+    public:
+        JsonPatternReader(std::istream& in, std::vector<std::string>& out)
+            : m_in(in), m_out(out) {}
+
+        bool Run(std::string& error)
+        {
+            SkipSpace();
+            if (Peek() == EOF) {
+                error = "empty document";
+                return false;
+            }
+            if (!Value(false, 0)) {
+                error = m_error + " at offset " + std::to_string(m_offset);
+                return false;
+            }
+            SkipSpace();
+            if (Peek() != EOF) {
+                error = "trailing data at offset " + std::to_string(m_offset);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        static constexpr int kMaxDepth = 64;
+
+        std::istream& m_in;
+        std::vector<std::string>& m_out;
+        std::string m_error;
+        std::size_t m_offset = 0;
+
+        int Peek() { return m_in.peek(); }
+
+        int Get()
+        {
+            const int c = m_in.get();
+            if (c != EOF)
+                ++m_offset;
+            return c;
+        }
+
+        bool Fail(const char* what)
+        {
+            m_error = what;
+            return false;
+        }
+
+        void SkipSpace()
+        {
+            for (int c = Peek(); c == ' ' || c == '\t' || c == '\r' || c == '\n'; c = Peek())
+                Get();
+        }
+
+        static bool LooksLikePattern(const std::string& s)
+        {
+            return s.find_first_of(".*?") != std::string::npos;
+        }
+
+        static bool IsReservedKey(const std::string& key)
+        {
+            return key.empty() || key[0] == '_' ||
+                key == "protected" || key == "injectable" || key == "reason";
+        }
+
+        static void AppendUtf8(std::string& out, std::uint32_t cp)
+        {
+            if (cp < 0x80) {
+                out.push_back(static_cast<char>(cp));
+            }
+            else if (cp < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else {
+                out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+
+        // Opening quote already consumed
+        bool String(std::string& out)
+        {
+            for (;;)
+            {
+                int c = Get();
+                if (c == EOF)
+                    return Fail("unterminated string");
+                if (c == '"')
+                    return true;
+                if (c != '\\') {
+                    out.push_back(static_cast<char>(c));
+                    continue;
+                }
+
+                c = Get();
+                switch (c)
+                {
+                case '"': case '\\': case '/': out.push_back(static_cast<char>(c)); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    std::uint32_t cp = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        const int h = Get();
+                        cp <<= 4;
+                        if (h >= '0' && h <= '9') cp |= static_cast<std::uint32_t>(h - '0');
+                        else if (h >= 'a' && h <= 'f') cp |= static_cast<std::uint32_t>(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') cp |= static_cast<std::uint32_t>(h - 'A' + 10);
+                        else return Fail("bad \\u escape");
+                    }
+                    AppendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return Fail("bad escape");
+                }
+            }
+        }
+
+        bool Literal(const char* word)
+        {
+            for (const char* p = word; *p; ++p)
+                if (Get() != *p)
+                    return Fail("bad literal");
+            return true;
+        }
+
+        bool Number()
+        {
+            bool any = false;
+            for (int c = Peek(); (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; c = Peek()) {
+                Get();
+                any = true;
+            }
+            return any ? true : Fail("unexpected character");
+        }
+
+        // inArray: a string here is a rule candidate
+        bool Value(bool inArray, int depth)
+        {
+            if (depth > kMaxDepth)
+                return Fail("nesting too deep");
+
+            SkipSpace();
+            const int c = Peek();
+
+            if (c == '"') {
+                Get();
+                std::string s;
+                if (!String(s))
+                    return false;
+                if (inArray && LooksLikePattern(s))
+                    m_out.push_back(std::move(s));
+                return true;
+            }
+            if (c == '{')
+                return Object(depth);
+            if (c == '[')
+                return Array(depth);
+            if (c == 't')
+                return Literal("true");
+            if (c == 'f')
+                return Literal("false");
+            if (c == 'n')
+                return Literal("null");
+            return Number();
+        }
+
+        bool Object(int depth)
+        {
+            Get();  // '{'
+            SkipSpace();
+            if (Peek() == '}') {
+                Get();
+                return true;
+            }
+
+            for (;;)
+            {
+                SkipSpace();
+                if (Get() != '"')
+                    return Fail("expected key");
+
+                std::string key;
+                if (!String(key))
+                    return false;
+
+                SkipSpace();
+                if (Get() != ':')
+                    return Fail("expected ':'");
+
+                if (!IsReservedKey(key) && LooksLikePattern(key))
+                    m_out.push_back(std::move(key));
+
+                if (!Value(false, depth + 1))
+                    return false;
+
+                SkipSpace();
+                const int c = Get();
+                if (c == '}')
+                    return true;
+                if (c != ',')
+                    return Fail("expected ',' or '}'");
+            }
+        }
+
+        bool Array(int depth)
+        {
+            Get();  // '['
+            SkipSpace();
+            if (Peek() == ']') {
+                Get();
+                return true;
+            }
+
+            for (;;)
+            {
+                if (!Value(true, depth + 1))
+                    return false;
+
+                SkipSpace();
+                const int c = Get();
+                if (c == ']')
+                    return true;
+                if (c != ',')
+                    return Fail("expected ',' or ']'");
+            }
+        }
+    };
+}
+
+inline bool ReadWhitelistPatterns(std::istream& in, std::vector<std::string>& outPatterns, std::string& outError)
+{
+    // UTF-8 BOM
+    if (in.peek() == 0xEF) {
+        char bom[3] = {};
+        in.read(bom, 3);
+        if (static_cast<std::uint8_t>(bom[1]) != 0xBB || static_cast<std::uint8_t>(bom[2]) != 0xBF) {
+            outError = "bad byte-order mark";
+            return false;
+        }
+    }
+
+    glob_detail::JsonPatternReader reader(in, outPatterns);
+    return reader.Run(outError);
+}
@@ -1,11 +1,21 @@
 #include "pch.h"
 #include "identity.h"
+#include "stage_tracer.hpp"
+#include "mapped_file.hpp"
+#include "multi_pattern.hpp"
+#include "log.hpp"
 #include <windows.h>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <unordered_set>
 #include <algorithm>
+#include <numeric>
+#include <execution>
+#include <cstring>
 
 static std::unordered_set<std::string> g_systemDependentPlugins;
 
@@ -18,85 +28,547 @@ static std::string ToLower(const std::string& s)
     return out;
 }
 
-// Efficient streaming search (no full file load)
-static bool StreamSearchFor(const std::string& filePath, const std::string& needle)
+// ============================================================================
+// DLL reference scan
+//
+// Every plugin name in Data is compiled into one case-insensitive
+// Aho-Corasick automaton (narrow and UTF-16LE spellings); each F4SE DLL is
+// then memory-mapped and only its initialized data sections are walked,
+// DLLs in parallel. Cost is O(DLL data bytes) instead of
+// O(DLLs x plugins x DLL bytes).
+// ============================================================================
+
+// Minimal PE layout (only the fields we read)
+#pragma pack(push, 1)
+struct PeDosHeader
+{
+    std::uint16_t magic;            // 'MZ'
+    std::uint8_t  unused[58];
+    std::int32_t  peOffset;         // e_lfanew
+};
+
+struct PeFileHeader
+{
+    std::uint32_t signature;        // 'PE\0\0'
+    std::uint16_t machine;
+    std::uint16_t numberOfSections;
+    std::uint32_t timeDateStamp;
+    std::uint32_t symbolTable;
+    std::uint32_t numberOfSymbols;
+    std::uint16_t sizeOfOptionalHeader;
+    std::uint16_t characteristics;
+};
+
+struct PeSectionHeader
+{
+    char          name[8];
+    std::uint32_t virtualSize;
+    std::uint32_t virtualAddress;
+    std::uint32_t sizeOfRawData;
+    std::uint32_t pointerToRawData;
+    std::uint32_t pointerToRelocations;
+    std::uint32_t pointerToLinenumbers;
+    std::uint16_t numberOfRelocations;
+    std::uint16_t numberOfLinenumbers;
+    std::uint32_t characteristics;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PeDosHeader) == 64, "PeDosHeader layout");
+static_assert(sizeof(PeSectionHeader) == 40, "PeSectionHeader layout");
+
+struct ByteRange
+{
+    std::size_t offset;
+    std::size_t size;
+};
+
+// File ranges of sections that hold initialized, non-executable,
+// non-discardable data (.rdata, .data, ...). Skips .text, .reloc and
+// uninitialized (.bss) sections. Returns false if the image is not a
+// well-formed PE, in which case the caller scans the whole file.
+static bool CollectInitializedDataRanges(const std::uint8_t* data, std::size_t size, std::vector<ByteRange>& out)
 {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file.is_open())
+    constexpr std::uint32_t kScnCode = 0x00000020;
+    constexpr std::uint32_t kScnInitializedData = 0x00000040;
+    constexpr std::uint32_t kScnDiscardable = 0x02000000;
+    constexpr std::uint32_t kScnExecute = 0x20000000;
+
+    out.clear();
+
+    if (size < sizeof(PeDosHeader))
+        return false;
+
+    PeDosHeader dos;
+    std::memcpy(&dos, data, sizeof(dos));
+    if (dos.magic != 0x5A4D || dos.peOffset < 0)
+        return false;
+
+    const std::size_t peOffset = static_cast<std::size_t>(dos.peOffset);
+    if (peOffset > size || size - peOffset < sizeof(PeFileHeader))
         return false;
 
-    const size_t chunkSize = 4096;
-    std::string buffer(chunkSize + needle.size(), '\0');
+    PeFileHeader fh;
+    std::memcpy(&fh, data + peOffset, sizeof(fh));
+    if (fh.signature != 0x00004550)
+        return false;
 
-    while (file.read(&buffer[0], chunkSize) || file.gcount() > 0)
+    const std::size_t sectionsOffset = peOffset + sizeof(PeFileHeader) + fh.sizeOfOptionalHeader;
+    const std::size_t sectionsBytes = static_cast<std::size_t>(fh.numberOfSections) * sizeof(PeSectionHeader);
+    if (sectionsOffset > size || size - sectionsOffset < sectionsBytes)
+        return false;
+
+    for (std::uint16_t i = 0; i < fh.numberOfSections; ++i)
     {
-        size_t bytesRead = file.gcount();
-        size_t searchSize = bytesRead + needle.size();
-
-        if (searchSize > buffer.size())
-            searchSize = buffer.size();
-
-        if (std::search(buffer.begin(),
-            buffer.begin() + searchSize,
-            needle.begin(),
-            needle.end(),
-            [](char a, char b) { return std::tolower(a) == std::tolower(b); })
-            != buffer.begin() + searchSize)
-        {
-            return true;
+        PeSectionHeader sh;
+        std::memcpy(&sh, data + sectionsOffset + i * sizeof(PeSectionHeader), sizeof(sh));
+
+        if (!(sh.characteristics & kScnInitializedData))
+            continue;
+        if (sh.characteristics & (kScnCode | kScnExecute | kScnDiscardable))
+            continue;
+        if (sh.pointerToRawData >= size || sh.sizeOfRawData == 0)
+            continue;
+
+        ByteRange r;
+        r.offset = sh.pointerToRawData;
+        r.size = std::min<std::size_t>(sh.sizeOfRawData, size - sh.pointerToRawData);
+        out.push_back(r);
+    }
+
+    return true;
+}
+
+// "Foo.esp" -> "F\0o\0o\0.\0e\0s\0p\0" (wchar_t literals, ASCII names)
+static std::string WidenUtf16LE(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size() * 2);
+    for (char c : s) {
+        out.push_back(c);
+        out.push_back('\0');
+    }
+    return out;
+}
+
+static bool HasExtension(const std::string& path, const char* ext)
+{
+    const std::size_t n = std::strlen(ext);
+    return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+}
+
+// ============================================================================
+// Scan cache (identity_cache.bin)
+//
+// DLL results are reused while the DLL's fingerprint is unchanged and the
+// cached scan searched for every plugin name currently in Data. A new
+// plugin name invalidates everything: old DLLs were never searched for it.
+//
+// Layout (little-endian), FNV-1a trailer over everything before it:
+//   "MXIC" | u32 version | u32 nameCount | nameCount x (u16 len | name)
+//   u32 dllCount | dllCount x (u16 len | path | u64 size | u64 mtime |
+//                              u64 headerHash | u32 hitCount | hitCount x u32 nameIndex)
+// ============================================================================
+
+static const char* kIdentityCachePath = "Data\\F4SE\\Plugins\\Multiplexer\\identity_cache.bin";
+static const char kIdentityCacheMagic[4] = { 'M', 'X', 'I', 'C' };
+static constexpr std::uint32_t kIdentityCacheVersion = 1;
+
+// Size + mtime catch ordinary updates; the header hash (first page: PE
+// headers incl. link timestamp and section table) catches rebuilds that
+// preserve both, without reading the whole DLL.
+struct DllFingerprint
+{
+    std::uint64_t size = 0;
+    std::uint64_t mtime = 0;
+    std::uint64_t headerHash = 0;
+
+    bool operator==(const DllFingerprint& o) const
+    {
+        return size == o.size && mtime == o.mtime && headerHash == o.headerHash;
+    }
+};
+
+struct IdentityCacheEntry
+{
+    std::string path;                    // lowercased
+    DllFingerprint fingerprint;
+    std::vector<std::uint32_t> hits;     // indices into IdentityCache::searchedNames
+};
+
+struct IdentityCache
+{
+    std::vector<std::string> searchedNames;   // lowercased plugin names
+    std::vector<IdentityCacheEntry> dlls;
+};
+
+static std::uint64_t Fnv1a64(const char* data, std::size_t size)
+{
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static bool FingerprintDll(const std::string& path, DllFingerprint& out)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec)
+        return false;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return false;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    char page[4096];
+    in.read(page, sizeof(page));
+
+    out.size = static_cast<std::uint64_t>(size);
+    out.mtime = static_cast<std::uint64_t>(mtime.time_since_epoch().count());
+    out.headerHash = Fnv1a64(page, static_cast<std::size_t>(in.gcount()));
+    return true;
+}
+
+template <typename T>
+static void PutPod(std::string& buf, T value)
+{
+    buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool GetPod(const std::vector<char>& buf, std::size_t& pos, T& value)
+{
+    if (buf.size() - pos < sizeof(T))
+        return false;
+    std::memcpy(&value, buf.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+static void PutString(std::string& buf, const std::string& s)
+{
+    const std::size_t n = std::min<std::size_t>(s.size(), 0xFFFF);
+    PutPod<std::uint16_t>(buf, static_cast<std::uint16_t>(n));
+    buf.append(s.data(), n);
+}
+
+static bool GetString(const std::vector<char>& buf, std::size_t& pos, std::string& s)
+{
+    std::uint16_t n = 0;
+    if (!GetPod(buf, pos, n) || buf.size() - pos < n)
+        return false;
+    s.assign(buf.data() + pos, n);
+    pos += n;
+    return true;
+}
+
+static bool LoadIdentityCache(IdentityCache& out)
+{
+    std::ifstream in(kIdentityCachePath, std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    std::vector<char> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (buf.size() < sizeof(kIdentityCacheMagic) + 8 + 8 ||
+        std::memcmp(buf.data(), kIdentityCacheMagic, sizeof(kIdentityCacheMagic)) != 0)
+        return false;
+
+    std::uint64_t stored = 0;
+    std::memcpy(&stored, buf.data() + buf.size() - 8, 8);
+    if (Fnv1a64(buf.data(), buf.size() - 8) != stored) {
+        logf("Identity: scan cache failed checksum; rescanning.");
+        return false;
+    }
+    buf.resize(buf.size() - 8);
+
+    std::size_t pos = sizeof(kIdentityCacheMagic);
+    std::uint32_t version = 0, nameCount = 0, dllCount = 0;
+    if (!GetPod(buf, pos, version) || version != kIdentityCacheVersion)
+        return false;
+
+    IdentityCache cache;
+    if (!GetPod(buf, pos, nameCount))
+        return false;
+    cache.searchedNames.resize(nameCount);
+    for (auto& name : cache.searchedNames) {
+        if (!GetString(buf, pos, name))
+            return false;
+    }
+
+    if (!GetPod(buf, pos, dllCount))
+        return false;
+    cache.dlls.resize(dllCount);
+    for (auto& e : cache.dlls)
+    {
+        std::uint32_t hitCount = 0;
+        if (!GetString(buf, pos, e.path) ||
+            !GetPod(buf, pos, e.fingerprint.size) ||
+            !GetPod(buf, pos, e.fingerprint.mtime) ||
+            !GetPod(buf, pos, e.fingerprint.headerHash) ||
+            !GetPod(buf, pos, hitCount))
+            return false;
+
+        e.hits.resize(hitCount);
+        for (auto& h : e.hits) {
+            if (!GetPod(buf, pos, h) || h >= nameCount)
+                return false;
         }
+    }
+
+    out = std::move(cache);
+    return true;
+}
+
+static void SaveIdentityCache(const IdentityCache& cache)
+{
+    std::string buf;
+    buf.append(kIdentityCacheMagic, sizeof(kIdentityCacheMagic));
+    PutPod<std::uint32_t>(buf, kIdentityCacheVersion);
 
-        // Move last few bytes to front for overlap
-        std::memmove(&buffer[0], &buffer[bytesRead], needle.size());
+    PutPod<std::uint32_t>(buf, static_cast<std::uint32_t>(cache.searchedNames.size()));
+    for (const auto& name : cache.searchedNames)
+        PutString(buf, name);
+
+    PutPod<std::uint32_t>(buf, static_cast<std::uint32_t>(cache.dlls.size()));
+    for (const auto& e : cache.dlls)
+    {
+        PutString(buf, e.path);
+        PutPod<std::uint64_t>(buf, e.fingerprint.size);
+        PutPod<std::uint64_t>(buf, e.fingerprint.mtime);
+        PutPod<std::uint64_t>(buf, e.fingerprint.headerHash);
+        PutPod<std::uint32_t>(buf, static_cast<std::uint32_t>(e.hits.size()));
+        for (std::uint32_t h : e.hits)
+            PutPod<std::uint32_t>(buf, h);
+    }
+
+    PutPod<std::uint64_t>(buf, Fnv1a64(buf.data(), buf.size()));
+
+    // Written beside the cache and renamed over it, so a crash mid-write
+    // leaves the previous cache intact
+    const std::string tmpPath = std::string(kIdentityCachePath) + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            logf("Identity: could not write scan cache '%s'.", tmpPath.c_str());
+            return;
+        }
+        out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        if (!out.flush()) {
+            logf("Identity: could not write scan cache '%s'.", tmpPath.c_str());
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
     }
 
-    return false;
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, kIdentityCachePath, ec);
+    if (ec) {
+        logf("Identity: could not replace scan cache '%s' (%s).", kIdentityCachePath, ec.message().c_str());
+        std::filesystem::remove(tmpPath, ec);
+    }
 }
 
+// ============================================================================
+// ScanDLLsForPluginReferences
+// ============================================================================
+
 static void ScanDLLsForPluginReferences()
 {
     std::string dllFolder = "Data\\F4SE\\Plugins";
+    std::error_code ec;
 
     // Collect plugin names from Data folder (not recursive)
     std::vector<std::string> pluginNames;
-    for (auto& entry : std::filesystem::directory_iterator("Data"))
+    for (auto& entry : std::filesystem::directory_iterator("Data", ec))
     {
         if (!entry.is_regular_file())
             continue;
 
         auto path = entry.path().string();
-        if (path.size() < 4)
-            continue;
-
-        std::string ext = path.substr(path.size() - 4);
-        if (ext == ".esp" || ext == ".esl")
+        if (HasExtension(path, ".esp") || HasExtension(path, ".esl"))
         {
             pluginNames.push_back(entry.path().filename().string());
         }
     }
 
-    // Scan DLLs for references to plugin names
-    for (auto& entry : std::filesystem::directory_iterator(dllFolder))
+    // Collect DLLs
+    std::vector<std::string> dllPaths;
+    for (auto& entry : std::filesystem::directory_iterator(dllFolder, ec))
     {
         if (!entry.is_regular_file())
             continue;
 
         auto dllPath = entry.path().string();
-        if (dllPath.size() < 4 || dllPath.substr(dllPath.size() - 4) != ".dll")
-            continue;
+        if (HasExtension(dllPath, ".dll"))
+            dllPaths.push_back(dllPath);
+    }
+
+    if (pluginNames.empty() || dllPaths.empty())
+        return;
 
-        for (auto& plugin : pluginNames)
+    std::vector<std::string> lowerNames(pluginNames.size());
+    std::unordered_map<std::string, std::uint32_t> idByLowerName;
+    for (std::size_t i = 0; i < pluginNames.size(); ++i) {
+        lowerNames[i] = ToLower(pluginNames[i]);
+        idByLowerName.emplace(lowerNames[i], static_cast<std::uint32_t>(i));
+    }
+
+    // ------------------------------------------------------------
+    // Cache: usable only if it searched for every current name
+    // ------------------------------------------------------------
+    IdentityCache cache;
+    bool cacheUsable = LoadIdentityCache(cache);
+    if (cacheUsable)
+    {
+        std::unordered_set<std::string> searched(cache.searchedNames.begin(), cache.searchedNames.end());
+        for (const auto& name : lowerNames)
         {
-            if (StreamSearchFor(dllPath, plugin))
-            {
-                g_systemDependentPlugins.insert(ToLower(plugin));
+            if (!searched.count(name)) {
+                logf("Identity: new plugin name '%s' since last scan; rescanning all DLLs.", name.c_str());
+                cacheUsable = false;
+                break;
             }
         }
     }
+
+    std::unordered_map<std::string, const IdentityCacheEntry*> cachedByPath;
+    if (cacheUsable) {
+        for (const auto& e : cache.dlls)
+            cachedByPath.emplace(e.path, &e);
+    }
+
+    std::vector<std::vector<std::uint32_t>> hitsPerDll(dllPaths.size());
+    std::vector<DllFingerprint> fingerprints(dllPaths.size());
+    std::vector<std::uint8_t> fingerprinted(dllPaths.size(), 0);
+    std::vector<std::size_t> toScan;
+
+    for (std::size_t di = 0; di < dllPaths.size(); ++di)
+    {
+        fingerprinted[di] = FingerprintDll(dllPaths[di], fingerprints[di]) ? 1 : 0;
+
+        auto it = cachedByPath.find(ToLower(dllPaths[di]));
+        if (!fingerprinted[di] || it == cachedByPath.end() || !(it->second->fingerprint == fingerprints[di])) {
+            toScan.push_back(di);
+            continue;
+        }
+
+        // Reuse: translate cached name indices to this run's plugin IDs
+        for (std::uint32_t h : it->second->hits)
+        {
+            auto id = idByLowerName.find(cache.searchedNames[h]);
+            if (id != idByLowerName.end())
+                hitsPerDll[di].push_back(id->second);
+        }
+    }
+
+    // ------------------------------------------------------------
+    // Scan new / changed DLLs; one pass each, in parallel
+    // ------------------------------------------------------------
+    std::vector<std::uint64_t> bytesPerDll(dllPaths.size(), 0);
+    std::vector<std::uint64_t> scannedPerDll(dllPaths.size(), 0);
+    std::vector<std::uint8_t> openFailed(dllPaths.size(), 0);
+
+    if (!toScan.empty())
+    {
+        MultiPatternMatcher matcher;
+        for (std::size_t i = 0; i < pluginNames.size(); ++i)
+        {
+            matcher.Add(pluginNames[i], static_cast<std::uint32_t>(i));
+            matcher.Add(WidenUtf16LE(pluginNames[i]), static_cast<std::uint32_t>(i));
+        }
+        matcher.Build();
+
+        std::for_each(std::execution::par, toScan.begin(), toScan.end(), [&](std::size_t di)
+            {
+                MappedFile dll;
+                if (!dll.Open(dllPaths[di])) {
+                    logf("Identity: could not map '%s'; it will be scanned again next launch.", dllPaths[di].c_str());
+                    openFailed[di] = 1;
+                    return;
+                }
+
+                std::vector<ByteRange> ranges;
+                if (!CollectInitializedDataRanges(dll.Data(), dll.Size(), ranges)) {
+                    ranges.clear();
+                    ranges.push_back(ByteRange{ 0, dll.Size() });
+                }
+
+                std::vector<std::uint8_t> seen(pluginNames.size(), 0);
+                std::vector<std::uint32_t>& hits = hitsPerDll[di];
+
+                for (const ByteRange& r : ranges)
+                {
+                    matcher.Scan(dll.Data() + r.offset, r.size, [&](std::uint32_t id)
+                        {
+                            if (!seen[id]) {
+                                seen[id] = 1;
+                                hits.push_back(id);
+                            }
+                        });
+                    scannedPerDll[di] += r.size;
+                }
+
+                bytesPerDll[di] = dll.Size();
+            });
+    }
+
+    std::size_t before = g_systemDependentPlugins.size();
+    std::uint64_t totalBytes = 0;
+    std::uint64_t scannedBytes = 0;
+    for (std::size_t di = 0; di < dllPaths.size(); ++di)
+    {
+        totalBytes += bytesPerDll[di];
+        scannedBytes += scannedPerDll[di];
+        for (std::uint32_t id : hitsPerDll[di])
+            g_systemDependentPlugins.insert(lowerNames[id]);
+    }
+
+    logf("Identity: %zu DLLs (%zu from cache, %zu scanned; %llu of %llu bytes in data sections) for %zu plugin names (ASCII + UTF-16LE); %zu new system-dependent plugins.",
+        dllPaths.size(),
+        dllPaths.size() - toScan.size(),
+        toScan.size(),
+        static_cast<unsigned long long>(scannedBytes),
+        static_cast<unsigned long long>(totalBytes),
+        pluginNames.size(),
+        g_systemDependentPlugins.size() - before);
+
+    // ------------------------------------------------------------
+    // Persist: every DLL below has now been searched for lowerNames
+    // ------------------------------------------------------------
+    if (toScan.empty() && cacheUsable && cache.searchedNames.size() == lowerNames.size() &&
+        cache.dlls.size() == dllPaths.size())
+        return;   // nothing changed
+
+    IdentityCache updated;
+    updated.searchedNames = lowerNames;
+    for (std::size_t di = 0; di < dllPaths.size(); ++di)
+    {
+        // A DLL that could not be read has no real result; scan it next launch
+        if (!fingerprinted[di] || openFailed[di])
+            continue;
+
+        IdentityCacheEntry e;
+        e.path = ToLower(dllPaths[di]);
+        e.fingerprint = fingerprints[di];
+        e.hits = hitsPerDll[di];
+        updated.dlls.push_back(std::move(e));
+    }
+    SaveIdentityCache(updated);
 }
 
 void Identity_Initialize()
 {
+    StageTraceSpan span(TraceCat::Stage, "Identity_Initialize");
+
     g_systemDependentPlugins.clear();
 
     // Hardcoded known system mods
@@ -115,3 +587,8 @@ bool IsSystemDependentCall(const char* pluginName)
     std::string lower = ToLower(pluginName);
     return g_systemDependentPlugins.count(lower) > 0;
 }
+
+const std::unordered_set<std::string>& Identity_GetSystemDependentPlugins()
+{
+    return g_systemDependentPlugins;
+}
@@ -4,3 +4,6 @@
 
 void Identity_Initialize();
 bool IsSystemDependentCall(const char* pluginName);
+
+// Lowercased names found by Identity_Initialize (feeds the name resolver)
+const std::unordered_set<std::string>& Identity_GetSystemDependentPlugins();
@@ -8,36 +8,61 @@
 #include "config.hpp"
 #include "records.hpp"
 #include "diagnostics.h"
-
+#include "stage_tracer.hpp"
+#include "form_tables.hpp"
+#include "formid_ledger.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <cstdint>
+#include <execution>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <fstream>
 
-// Injection subsystem context
-static InjectionContext g_injectionContext;
+// Injection subsystem context. The rewrite hook reads the image without a
+// lock, so a new image is built off to the side and published with one
+// pointer swap; replaced images are retired, never freed (a reader may
+// still be walking one).
+static std::atomic<const InjectionContext*> g_injectionContext{ nullptr };
+static std::mutex g_injectionPublishMutex;
+static std::vector<std::unique_ptr<InjectionContext>> g_retiredInjectionContexts;
 
-void InitInjectionContext(
-    const SlotDescriptor& slot,
-    const std::vector<ModuleDescriptor>& modules)
+static const InjectionContext* CurrentInjectionContext()
 {
-    g_injectionContext.slot = &slot;
-    g_injectionContext.modules = &modules;
-
-    logf("Injection subsystem initialized: %zu modules, slot fileIndex=0x%02X",
-        modules.size(), slot.fileIndex);
+    return g_injectionContext.load(std::memory_order_acquire);
 }
 
-std::string ExplainFormIDRewrite(uint32_t originalFormID, uint32_t rewrittenFormID)
+void InitInjectionContext(
+    const std::vector<SlotDescriptor>& slots,
+    const CSVSlotIndex* csvIndex)
 {
-    if (originalFormID == rewrittenFormID)
-        return "FormID was not rewritten (no mapping applied).";
+    std::unique_ptr<InjectionContext> ctx(new InjectionContext());
+    ctx->csvIndex = csvIndex;
 
-    return "FormID was rewritten from " +
-        std::to_string(originalFormID) + " to " +
-        std::to_string(rewrittenFormID) +
-        " based on module formIdMap mapping into the dummy slot.";
+    // Merge every slot's modules into one image (slot order, then module order)
+    for (const SlotDescriptor& slot : slots)
+    {
+        if (slot.refused)
+            continue;
+        ctx->slots.push_back(&slot);
+        for (const ModuleDescriptor& m : slot.modules)
+            ctx->modules.push_back(RewriteModule{ &m, &slot });
+    }
+
+    logf("Injection subsystem initialized: %zu modules in %zu of %zu dummy slots, CSV rows=%zu",
+        ctx->modules.size(), ctx->slots.size(), slots.size(),
+        csvIndex ? csvIndex->Rows().size() : (std::size_t)0);
+
+    std::lock_guard<std::mutex> lock(g_injectionPublishMutex);
+    g_injectionContext.store(ctx.get(), std::memory_order_release);
+    g_retiredInjectionContexts.push_back(std::move(ctx));
 }
 
 namespace
@@ -84,40 +109,34 @@ namespace
         return out;
     }
 
-    static const ModuleDescriptor* FindModuleForDecodedID(const DecodedFormID& id)
+    static const RewriteModule* FindModuleForDecodedID(const InjectionContext& ctx, const DecodedFormID& id)
     {
-        if (!g_injectionContext.modules)
-            return 0;
-
-        const std::vector<ModuleDescriptor>& mods = *g_injectionContext.modules;
+        const std::vector<RewriteModule>& mods = ctx.modules;
 
         for (std::size_t i = 0; i < mods.size(); ++i)
         {
-            const ModuleDescriptor& m = mods[i];
+            const ModuleDescriptor& m = *mods[i].module;
 
             if (m.containsWorldspace)
                 continue;
 
             if (m.isESL && id.isESL && id.pluginIndex == 0xFE && id.eslSlot == m.eslSlot)
-                return &m;
+                return &mods[i];
 
             if (!m.isESL && !id.isESL && id.pluginIndex == m.originalFileIndex)
-                return &m;
+                return &mods[i];
         }
 
         return 0;
     }
 
-    static bool IsFormIDInSlot(const DecodedFormID& id)
+    static bool IsFormIDInSlot(const InjectionContext& ctx, const DecodedFormID& id)
     {
-        if (!g_injectionContext.modules)
-            return false;
-
-        const std::vector<ModuleDescriptor>& mods = *g_injectionContext.modules;
+        const std::vector<RewriteModule>& mods = ctx.modules;
 
         for (std::size_t i = 0; i < mods.size(); ++i)
         {
-            const ModuleDescriptor& m = mods[i];
+            const ModuleDescriptor& m = *mods[i].module;
 
             if (m.containsWorldspace)
                 continue;
@@ -149,39 +168,34 @@ namespace
             mod->name.c_str(), localKey);
     }
 
-    inline std::uint32_t compose_formid(std::uint32_t virtualID, std::uint32_t local)
+    // Dummy plugin fileIndex + object ID -> FormID
+    inline std::uint32_t compose_formid(std::uint8_t fileIndex, std::uint32_t local)
     {
-        return (virtualID << 24) | (local & 0x00FFFFFFu);
+        return (static_cast<std::uint32_t>(fileIndex) << 24) | (local & 0x00FFFFFFu);
     }
 
     inline std::uint32_t remap_lvli_ref(
         std::uint32_t refFormID,
-        const std::unordered_map<std::uint32_t, std::uint32_t>& formIdMap,
+        const SealedFormMap& formIds,
         bool isESL,
         std::uint16_t eslSlot)
     {
+        std::uint32_t target = 0;
         const std::uint32_t hi = (refFormID & 0xFF000000u);
         const std::uint32_t local = (refFormID & 0x00FFFFFFu);
 
         if (!isESL)
         {
-            if (hi == 0x00000000u)
-            {
-                std::unordered_map<std::uint32_t, std::uint32_t>::const_iterator it =
-                    formIdMap.find(local);
-                if (it != formIdMap.end())
-                    return it->second;
-            }
+            if (hi == 0x00000000u && formIds.Find(local, target))
+                return target;
             return refFormID;
         }
 
         if (hi == 0x00000000u)
         {
             const std::uint32_t compact = local & 0x00000FFFu;
-            std::unordered_map<std::uint32_t, std::uint32_t>::const_iterator it =
-                formIdMap.find(compact);
-            if (it != formIdMap.end())
-                return it->second;
+            if (formIds.Find(compact, target))
+                return target;
             return refFormID;
         }
 
@@ -190,13 +204,8 @@ namespace
             const std::uint16_t slot = (std::uint16_t)((local >> 12) & 0x0FFFu);
             const std::uint32_t compact = local & 0x00000FFFu;
 
-            if (slot == eslSlot)
-            {
-                std::unordered_map<std::uint32_t, std::uint32_t>::const_iterator it =
-                    formIdMap.find(compact);
-                if (it != formIdMap.end())
-                    return it->second;
-            }
+            if (slot == eslSlot && formIds.Find(compact, target))
+                return target;
         }
 
         return refFormID;
@@ -206,8 +215,9 @@ namespace
         std::uint32_t targetFormID,
         std::uint32_t recordType,
         const RecordPayload& payload,
-        const std::unordered_map<std::uint32_t, std::uint32_t>& formIdMap,
+        const SealedFormMap& formIds,
         const std::string& moduleName,
+        PluginModuleId moduleId,
         bool isESL,
         std::uint16_t eslSlot)
     {
@@ -220,7 +230,10 @@ namespace
         for (std::size_t i = 0; i < payload.lvliEntries.size(); ++i)
         {
             const RecordPayload::LvliEntry& entry = payload.lvliEntries[i];
-            std::uint32_t remapped = remap_lvli_ref(entry.formID, formIdMap, isESL, eslSlot);
+            std::uint32_t remapped = remap_lvli_ref(entry.formID, formIds, isESL, eslSlot);
+            if (remapped != entry.formID)
+                Diagnostics_RecordPluginLVLIRemap(moduleId);
+
             if (remapped != entry.formID && g_eslDebug)
             {
                 logf("  LVLI entry remap (%s): %08X -> %08X",
@@ -232,23 +245,233 @@ namespace
 
         return true;
     }
+}
+
+// ============================================================================
+// On-demand rewrite explanation
+//
+// Walks the same decode -> module -> formIdMap path as ResolveAndRewriteFormID,
+// then looks up the module's CSV routing, recording each step as it goes.
+// ============================================================================
+
+FormIDRewriteExplanation ExplainFormIDRewriteLive(uint32_t formID)
+{
+    FormIDRewriteExplanation ex;
+    ex.formID = formID;
+
+    DecodedFormID decoded = DecodeFormID(formID);
+    ex.pluginIndex = decoded.pluginIndex;
+    ex.isESLForm = decoded.isESL;
+    ex.eslSlot = decoded.eslSlot;
+    ex.localID = decoded.localID;
+
+    if (decoded.isESL)
+        ex.chain.push_back("Decoded " + to_hex(formID) + " as ESL form: FE slot 0x" +
+            to_hex(decoded.eslSlot).substr(5) + ", local 0x" + to_hex(decoded.localID).substr(5));
+    else
+        ex.chain.push_back("Decoded " + to_hex(formID) + " as full form: plugin index 0x" +
+            to_hex(decoded.pluginIndex).substr(6) + ", local 0x" + to_hex(decoded.localID).substr(2));
+
+    if (!g_enableRuntimeRewrite)
+        ex.chain.push_back("Runtime rewrite is disabled (bEnableRuntimeRewrite=0); FormID is passed through.");
+
+    const InjectionContext* ctx = CurrentInjectionContext();
+    if (!ctx) {
+        ex.chain.push_back("No rewrite image is active (pipeline not run, ScanOnStartup=0, or game data not loaded yet).");
+        return ex;
+    }
+
+    const RewriteModule* owner = FindModuleForDecodedID(*ctx, decoded);
+    if (!owner) {
+        ex.chain.push_back(decoded.isESL ?
+            "No multiplexed ESL module owns this FE slot; FormID is not rewritten." :
+            "No multiplexed module owns this plugin index; FormID is not rewritten.");
+        return ex;
+    }
 
-    const CSVSlot* find_slot_for_plugin(
-        const std::vector<CSVSlot>& slots,
-        const std::string& pluginName)
+    const ModuleDescriptor* mod = owner->module;
+    ex.module = mod;
+    ex.slot = owner->slot;
+    ex.slotFileIndex = owner->slot->fileIndex;
+    ex.chain.push_back("Owned by module '" + mod->name + "'" +
+        (mod->isESL ? " (ESL, FE slot 0x" + to_hex(mod->eslSlot).substr(5) + ")" : " (full plugin)"));
+
+    ex.localKey = mod->isESL ?
+        (decoded.localID & 0x00000FFFu) :
+        (decoded.localID & 0x00FFFFFFu);
+    ex.chain.push_back("Local key 0x" + to_hex(ex.localKey).substr(2) +
+        (mod->isESL ? " (12-bit compact key)" : " (24-bit key)"));
+
+    if (!mod->formIds.Find(ex.localKey, ex.targetFormID)) {
+        ex.targetFormID = 0;
+        ex.chain.push_back("Local key is not present in the module formIdMap; FormID is not rewritten.");
+    }
+    else {
+        ex.mapped = true;
+        ex.chain.push_back("formIdMap maps it to " + to_hex(ex.targetFormID) +
+            " in dummy slot '" + ex.slot->dummyName + "' (fileIndex 0x" + to_hex(ex.slotFileIndex).substr(6) + ")");
+    }
+
+    if (ctx->csvIndex) {
+        const CSVSlotIndex& index = *ctx->csvIndex;
+        const std::size_t row = index.FindRow(mod->name);
+        if (row != CSVSlotIndex::npos) {
+            ex.csvSlot = &index.Rows()[row];
+            ex.csvRow = row + 1;
+            ex.chain.push_back("CSV row " + std::to_string(ex.csvRow) + " routes it to '" +
+                ex.csvSlot->dummyPlugin + "' (Virtual_ID " + std::to_string(ex.csvSlot->virtualID) + ")");
+        }
+        else {
+            ex.chain.push_back("Module is not listed in the CSV mapping; records are not injected.");
+        }
+    }
+
+    return ex;
+}
+
+std::string ExplainFormIDRewrite(uint32_t originalFormID, uint32_t rewrittenFormID)
+{
+    if (originalFormID == rewrittenFormID)
+        return "FormID was not rewritten (no mapping applied).";
+
+    FormIDRewriteExplanation ex = ExplainFormIDRewriteLive(originalFormID);
+
+    std::string out = "FormID was rewritten from " + to_hex(originalFormID) +
+        " to " + to_hex(rewrittenFormID) + ":";
+    for (std::size_t i = 0; i < ex.chain.size(); ++i)
+    {
+        std::string step = ex.chain[i];
+        if (!step.empty() && step.back() == '.')
+            step.pop_back();
+        out += (i == 0 ? " " : "; ") + step;
+    }
+    out += ".";
+
+    return out;
+}
+
+const ModuleDescriptor* FindRewriteModuleByName(const std::string& moduleName)
+{
+    const InjectionContext* ctx = CurrentInjectionContext();
+    if (!ctx)
+        return 0;
+
+    const std::vector<RewriteModule>& mods = ctx->modules;
+    for (std::size_t i = 0; i < mods.size(); ++i)
     {
-        for (std::size_t i = 0; i < slots.size(); ++i)
+        if (_stricmp(mods[i].module->name.c_str(), moduleName.c_str()) == 0)
+            return mods[i].module;
+    }
+
+    return 0;
+}
+
+bool FindVirtualFormIDSource(uint32_t virtualFormID, VirtualFormIDSource& out)
+{
+    const InjectionContext* ctx = CurrentInjectionContext();
+    if (!ctx)
+        return false;
+
+    const uint8_t fileIndex = static_cast<uint8_t>(virtualFormID >> 24);
+    for (const SlotDescriptor* slotPtr : ctx->slots)
+    {
+        const SlotDescriptor& slot = *slotPtr;
+        if (slot.fileIndex != fileIndex)
+            continue;
+
+        ReverseFormIndex::Source source;
+        if (!slot.reverseIds.Find(virtualFormID, source))
+            return false;
+
+        out.slot = &slot;
+        out.module = &slot.modules[source.module];
+        out.localKey = source.localKey;
+        return true;
+    }
+
+    return false;
+}
+
+// Sealed form map benchmark (mx bench formmaps)
+std::vector<FormMapBenchResult> BenchmarkFormMaps()
+{
+    // Enough lookups per module for steady_clock to resolve the difference
+    const std::size_t kTargetLookups = std::size_t(1) << 20;
+
+    std::vector<FormMapBenchResult> results;
+    std::uint32_t sink = 0;
+
+    const InjectionContext* ctx = CurrentInjectionContext();
+    if (!ctx)
+        return results;
+
+    const std::vector<RewriteModule>& mods = ctx->modules;
+    for (std::size_t i = 0; i < mods.size(); ++i)
+    {
+        const ModuleDescriptor& m = *mods[i].module;
+        const SealedFormMap& sealed = m.formIds;
+        if (sealed.Empty())
+            continue;
+
+        // The map the module carried before sealing
+        std::unordered_map<std::uint32_t, std::uint32_t> nodes;
+        nodes.reserve(sealed.Size());
+        for (std::size_t k = 0; k < sealed.Size(); ++k)
+            nodes.emplace(sealed.KeyAt(k), sealed.ValueAt(k));
+
+        // Every key once plus as many misses, shuffled (Fisher-Yates)
+        std::vector<std::uint32_t> queries;
+        queries.reserve(sealed.Size() * 2);
+        for (std::size_t k = 0; k < sealed.Size(); ++k)
         {
-            const CSVSlot& slot = slots[i];
-            for (std::size_t j = 0; j < slot.sourceMods.size(); ++j)
+            queries.push_back(sealed.KeyAt(k));
+            std::uint32_t miss = (sealed.KeyAt(k) * 2654435761u) & 0x00FFFFFFu;
+            while (nodes.count(miss))
+                miss = (miss + 1) & 0x00FFFFFFu;
+            queries.push_back(miss);
+        }
+        std::mt19937 rng(0x5EA1ED);   // fixed seed: the same order every run
+        for (std::size_t k = queries.size(); k > 1; --k)
+            std::swap(queries[k - 1], queries[std::uniform_int_distribution<std::size_t>(0, k - 1)(rng)]);
+
+        const std::size_t rounds = std::max<std::size_t>(1, kTargetLookups / queries.size());
+        const double lookups = static_cast<double>(rounds * queries.size());
+
+        const auto t0 = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::uint32_t q : queries)
             {
-                const std::string& mod = slot.sourceMods[j];
-                if (_stricmp(mod.c_str(), pluginName.c_str()) == 0)
-                    return &slot;
+                std::uint32_t v = 0;
+                if (sealed.Find(q, v))
+                    sink += v;
             }
-        }
-        return 0;
+        const auto t1 = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::uint32_t q : queries)
+            {
+                std::unordered_map<std::uint32_t, std::uint32_t>::const_iterator it = nodes.find(q);
+                if (it != nodes.end())
+                    sink += it->second;
+            }
+        const auto t2 = std::chrono::steady_clock::now();
+
+        FormMapBenchResult row;
+        row.module = m.name;
+        row.entries = sealed.Size();
+        row.sealedNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / lookups;
+        row.mapNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / lookups;
+        row.sealedBytes = sealed.MemoryBytes();
+        // Node (value + two links) per entry plus the bucket array; allocator overhead not counted
+        row.mapBytes = nodes.size() * (sizeof(std::pair<const std::uint32_t, std::uint32_t>) + 2 * sizeof(void*)) +
+            nodes.bucket_count() * 2 * sizeof(void*);
+        results.push_back(row);
     }
+
+    // Keeps the lookups from being optimized away
+    if (sink == 0x5EA1ED)
+        logf("BenchmarkFormMaps: checksum %08X", sink);
+
+    return results;
 }
 
 // Runtime FormID rewrite
@@ -257,32 +480,32 @@ uint32_t ResolveAndRewriteFormID(uint32_t formID)
     if (!g_enableRuntimeRewrite)
         return formID;
 
-    if (!g_injectionContext.slot || !g_injectionContext.modules)
+    const InjectionContext* ctx = CurrentInjectionContext();
+    if (!ctx || ctx->modules.empty())
         return formID;
 
     DecodedFormID decoded = DecodeFormID(formID);
 
-    if (!IsFormIDInSlot(decoded))
+    if (!IsFormIDInSlot(*ctx, decoded))
         return formID;
 
-    const ModuleDescriptor* mod = FindModuleForDecodedID(decoded);
-    if (!mod)
+    const RewriteModule* owner = FindModuleForDecodedID(*ctx, decoded);
+    if (!owner)
         return formID;
 
+    const ModuleDescriptor* mod = owner->module;
+
     uint32_t localKey = mod->isESL ?
         (decoded.localID & 0x00000FFFu) :
         (decoded.localID & 0x00FFFFFFu);
 
-    std::unordered_map<std::uint32_t, std::uint32_t>::const_iterator it =
-        mod->formIdMap.find(localKey);
-    if (it == mod->formIdMap.end())
+    uint32_t targetFormID = 0;
+    if (!mod->formIds.Find(localKey, targetFormID))
     {
         ReportMissingMapping(mod, localKey);
         return formID;
     }
 
-    uint32_t targetFormID = it->second;
-
     if (g_eslDebug)
     {
         logf("Rewrite: module=%s original=%08X localKey=%06X target=%08X",
@@ -310,19 +533,97 @@ bool mount_archives(SlotDescriptor& slot)
     return true;
 }
 
+// Recorded FormID traces (debug logging only): one row per entry of the
+// module's finished formIdMap. Entries the ledger already held are marked
+// as such; the rest carry 'fresh' (how this path placed them).
+static void record_form_map_traces(
+    const ModuleDescriptor& m,
+    const SlotDescriptor& slot,
+    const FormIdLedger& ledger,
+    FormIDTraceReason fresh)
+{
+    if (!g_debugLogging || m.formIdMap.empty())
+        return;
+
+    const FormIdLedger::KeyMap* known = ledger.Module(m.name);
+    const std::uint32_t dummy = ledger.Dummy(slot.dummyName);
+
+    std::vector<FormIDTraceRow> rows;
+    rows.reserve(m.formIdMap.size());
+    for (const auto& kv : m.formIdMap)
+    {
+        std::uint32_t ledgered = 0;
+        const bool inLedger = FormIdLedger::Find(known, kv.first, dummy, ledgered) &&
+            compose_formid(slot.fileIndex, ledgered) == kv.second;
+        const std::uint32_t original = m.isESL ?
+            (0xFE000000u | (std::uint32_t(m.eslSlot) << 12) | kv.first) :
+            compose_formid(m.originalFileIndex, kv.first);
+
+        rows.push_back(FormIDTraceRow{ original, kv.first, kv.second,
+            inLedger ? FormIDTraceReason::LedgerAssignment : fresh });
+    }
+
+    Diagnostics_RecordFormIDTraces(m.moduleId, m.isESL, "0x" + to_hex(slot.fileIndex).substr(6), rows);
+}
+
+// Maps a module's sorted local keys into the slot's dummy plugin: keys the
+// ledger already placed there keep their object ID (the caller has
+// reserved them), the rest take the lowest free IDs. All or nothing.
+static bool assign_form_ids(
+    ModuleDescriptor& m,
+    const std::vector<std::uint32_t>& keys,
+    const SlotDescriptor& slot,
+    FormIdAllocator& ids,
+    const FormIdLedger& ledger)
+{
+    const FormIdLedger::KeyMap* known = ledger.Module(m.name);
+    const std::uint32_t dummy = ledger.Dummy(slot.dummyName);
+    std::uint32_t objectID = 0;
+
+    std::size_t freshCount = 0;
+    for (std::size_t k = 0; k < keys.size(); ++k)
+        if (!FormIdLedger::Find(known, keys[k], dummy, objectID))
+            ++freshCount;
+
+    std::vector<std::uint32_t> fresh;
+    if (!ids.AllocateRun(freshCount, fresh))
+        return false;
+
+    m.formIdMap.reserve(keys.size());
+    std::size_t next = 0;
+    for (std::size_t k = 0; k < keys.size(); ++k)
+    {
+        if (!FormIdLedger::Find(known, keys[k], dummy, objectID))
+            objectID = fresh[next++];
+        m.formIdMap.emplace(keys[k], compose_formid(slot.fileIndex, objectID));
+    }
+
+    record_form_map_traces(m, slot, ledger,
+        m.isESL ? FormIDTraceReason::ESLCompactKey : FormIDTraceReason::FormIdMap);
+    return true;
+}
+
 // Build form maps
-bool build_form_maps(SlotDescriptor& slot)
+bool build_form_maps(
+    SlotDescriptor& slot,
+    FormIdAllocator& ids,
+    const FormIdLedger& ledger,
+    std::vector<FormMapOverflow>& outOverflow)
 {
-    std::uint32_t subBase = 0x000100u;
+    StageTraceSpan stageSpan(TraceCat::Stage, "build_form_maps");
 
     log_progress("Building form maps", 0, (int)slot.modules.size());
 
+    std::vector<std::uint32_t> keys;
+
     for (std::size_t mi = 0; mi < slot.modules.size(); ++mi)
     {
         ModuleDescriptor& m = slot.modules[mi];
+        StageTraceSpan moduleSpan(TraceCat::Module, m.name);
 
         if (m.containsWorldspace)
         {
+            moduleSpan.AddArg("skipped", std::string("worldspace"));
             logf("Skipping form map build for '%s' (contains worldspace records).", m.name.c_str());
             log_progress("Building form maps", (int)(mi + 1), (int)slot.modules.size());
             continue;
@@ -330,63 +631,137 @@ bool build_form_maps(SlotDescriptor& slot)
 
         std::vector<RawRecord> recs = scan_plugin_records(m.name, m);
 
+        keys.clear();
+        keys.reserve(recs.size());
         for (std::size_t ri = 0; ri < recs.size(); ++ri)
         {
             const RawRecord& r = recs[ri];
-
-            const std::uint32_t localKey = m.isESL ?
+            keys.push_back(m.isESL ?
                 (r.localFormID & 0x00000FFFu) :
-                (r.localFormID & 0x00FFFFFFu);
+                (r.localFormID & 0x00FFFFFFu));
+        }
 
-            const std::uint32_t target = compose_formid(slot.fileIndex, subBase + localKey);
+        // Stable order: ascending local key, so the same plugin always packs the same way
+        std::sort(keys.begin(), keys.end());
+        const std::size_t collected = keys.size();
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        if (keys.size() != collected && g_eslDebug)
+        {
+            logf("WARNING: %zu duplicate local keys in module '%s' (ESL=%s)",
+                collected - keys.size(),
+                m.name.c_str(),
+                m.isESL ? "YES" : "NO");
+        }
 
-            std::pair<std::unordered_map<std::uint32_t, std::uint32_t>::iterator, bool> ins =
-                m.formIdMap.insert(std::make_pair(localKey, target));
-            if (!ins.second && g_eslDebug)
-            {
-                logf("WARNING: Duplicate local key %06X in module '%s' (ESL=%s)",
-                    localKey,
-                    m.name.c_str(),
-                    m.isESL ? "YES" : "NO");
-            }
+        if (!assign_form_ids(m, keys, slot, ids, ledger))
+        {
+            moduleSpan.AddArg("overflow", keys.size());
+            logf("Form map for %s does not fit in slot 0x%02X (%zu IDs needed, %u free).",
+                m.name.c_str(), slot.fileIndex, keys.size(), ids.Free());
+            outOverflow.push_back(FormMapOverflow{ mi, keys });
+            log_progress("Building form maps", (int)(mi + 1), (int)slot.modules.size());
+            continue;
         }
 
+        moduleSpan.AddArg("records", recs.size());
+        moduleSpan.AddArg("formIdMap", m.formIdMap.size());
+
         logf("Form map built for %s: %zu entries", m.name.c_str(), m.formIdMap.size());
         log_progress("Building form maps", (int)(mi + 1), (int)slot.modules.size());
-
-        subBase += 0x000400u;
     }
 
+    stageSpan.AddArg("idsUsed", ids.Used());
+
     return true;
 }
 
+// Seal form maps
+void seal_form_maps(SlotDescriptor& slot)
+{
+    StageTraceSpan stageSpan(TraceCat::Stage, "seal_form_maps");
+
+    std::size_t nodeEntries = 0, sealedBytes = 0, collisions = 0;
+    slot.reverseIds.Clear();
+
+    for (std::size_t mi = 0; mi < slot.modules.size(); ++mi)
+    {
+        ModuleDescriptor& m = slot.modules[mi];
+        nodeEntries += m.formIdMap.size();
+        m.formIds.Build(m.formIdMap);
+        sealedBytes += m.formIds.MemoryBytes();
+        std::unordered_map<std::uint32_t, std::uint32_t>().swap(m.formIdMap);
+
+        // Reverse index; a target claimed twice means two records share a FormID
+        for (std::size_t i = 0; i < m.formIds.Size(); ++i)
+        {
+            const std::uint32_t target = m.formIds.ValueAt(i);
+            ReverseFormIndex::Source first;
+            if ((target >> 24) == slot.fileIndex &&
+                slot.reverseIds.Add(target, static_cast<std::uint32_t>(mi), m.formIds.KeyAt(i), first))
+                continue;
+
+            ++collisions;
+            char msg[256];
+            if ((target >> 24) != slot.fileIndex)
+                std::snprintf(msg, sizeof(msg), "%s: %s local 0x%06X maps to 0x%08X, outside dummy plugin %02X.",
+                    slot.dummyName.c_str(), m.name.c_str(), m.formIds.KeyAt(i), target, slot.fileIndex);
+            else
+                std::snprintf(msg, sizeof(msg), "%s: FormID 0x%08X assigned to both %s local 0x%06X and %s local 0x%06X.",
+                    slot.dummyName.c_str(), target, slot.modules[first.module].name.c_str(), first.localKey,
+                    m.name.c_str(), m.formIds.KeyAt(i));
+            logf("ERROR: %s", msg);
+            Diagnostics_RecordMappingIssue(msg);
+        }
+    }
+
+    stageSpan.AddArg("entries", nodeEntries);
+    stageSpan.AddArg("bytes", sealedBytes);
+    stageSpan.AddArg("reverseBytes", slot.reverseIds.MemoryBytes());
+    stageSpan.AddArg("collisions", collisions);
+}
+
 // Inject records
 bool inject_records(
     const SlotDescriptor& slot,
-    const std::vector<CSVSlot>& csvSlots)
+    const CSVSlotIndex& csvIndex,
+    const FormTables* tables)
 {
+    StageTraceSpan stageSpan(TraceCat::Stage, "inject_records");
+
     log_progress("Injecting modules", 0, (int)slot.modules.size());
 
     for (std::size_t mi = 0; mi < slot.modules.size(); ++mi)
     {
         const ModuleDescriptor& m = slot.modules[mi];
+        StageTraceSpan moduleSpan(TraceCat::Module, m.name);
 
         if (m.containsWorldspace)
         {
+            moduleSpan.AddArg("skipped", std::string("worldspace"));
+            Diagnostics_RecordPluginSkip(m.moduleId);
             logf("Skipping injection for '%s' (contains worldspace records).", m.name.c_str());
             log_progress("Injecting modules", (int)(mi + 1), (int)slot.modules.size());
             continue;
         }
 
-        const CSVSlot* csvSlot = find_slot_for_plugin(csvSlots, m.name);
+        const CSVSlot* csvSlot = csvIndex.Find(m.name);
         if (!csvSlot)
         {
+            moduleSpan.AddArg("skipped", std::string("not in CSV"));
+            Diagnostics_RecordPluginSkip(m.moduleId);
             logf("WARNING: Plugin '%s' not found in CSV - skipping.", m.name.c_str());
             log_progress("Injecting modules", (int)(mi + 1), (int)slot.modules.size());
             continue;
         }
 
-        std::vector<RawRecord> recs = scan_plugin_records(m.name, const_cast<ModuleDescriptor&>(m));
+        // Table-backed modules were never scanned; their table has the records
+        std::vector<RawRecord> recs;
+        const bool fromTable = tables && m.formTableModule != 0xFFFFFFFFu &&
+            tables->Records(m.formTableModule, recs);
+        if (!fromTable)
+            recs = scan_plugin_records(m.name, const_cast<ModuleDescriptor&>(m));
+        moduleSpan.AddArg("source", std::string(fromTable ? "form_tables" : "scan"));
+
         if (recs.empty())
         {
             logf("No records to inject for %s", m.name.c_str());
@@ -407,60 +782,361 @@ bool inject_records(
                 (r.localFormID & 0x00000FFFu) :
                 (r.localFormID & 0x00FFFFFFu);
 
-            const std::uint32_t targetFormID =
-                compose_formid(csvSlot->virtualID, localKey);
+            // The FormID the allocator / ledger gave this record
+            std::uint32_t targetFormID = 0;
+            if (!m.formIds.Find(localKey, targetFormID))
+            {
+                logf("WARNING: %s local 0x%06X has no form map entry - not injected.",
+                    m.name.c_str(), localKey);
+                log_progress("Injecting " + m.name, (int)(i + 1), (int)recs.size());
+                continue;
+            }
 
             if (inject_single_record_stub(
                 targetFormID,
                 r.type,
                 r.payload,
-                m.formIdMap,
+                m.formIds,
                 m.name,
+                m.moduleId,
                 m.isESL,
                 m.eslSlot))
             {
                 ++injected;
+                Diagnostics_RecordPluginInjection(m.moduleId);
             }
 
             log_progress("Injecting " + m.name, (int)(i + 1), (int)recs.size());
         }
 
+        moduleSpan.AddArg("records", recs.size());
+        moduleSpan.AddArg("injected", injected);
+
         logf("Stub-injected %zu forms for %s", injected, m.name.c_str());
         log_progress("Injecting modules", (int)(mi + 1), (int)slot.modules.size());
     }
 
-    // SkippedModules.txt
-    if (g_writeSkippedModules)
+    return true;
+}
+
+// SkippedModules.txt (worldspace modules across every dummy slot)
+static void write_skipped_modules(const SlotDescriptor& registry)
+{
+    if (!g_writeSkippedModules)
+        return;
+
+    const char* outPath = "Data\\F4SE\\Plugins\\Multiplexer\\SkippedModules.txt";
+    std::ofstream out(outPath, std::ios::out | std::ios::trunc);
+
+    if (out.is_open())
     {
-        const char* outPath = "Data\\F4SE\\Plugins\\Multiplexer\\SkippedModules.txt";
-        std::ofstream out(outPath, std::ios::out | std::ios::trunc);
+        out << "=== Multiplexer: Skipped Modules (Worldspace Detected) ===\n\n";
 
-        if (out.is_open())
+        bool any = false;
+        for (std::size_t i = 0; i < registry.modules.size(); ++i)
         {
-            out << "=== Multiplexer: Skipped Modules (Worldspace Detected) ===\n\n";
+            const ModuleDescriptor& m = registry.modules[i];
+            if (m.containsWorldspace)
+            {
+                any = true;
+                out << m.name << "\n";
+            }
+        }
+
+        if (!any)
+            out << "(none)\n";
+
+        out.close();
+        logf("SkippedModules.txt written (%s)", any ? "entries present" : "no skipped modules");
+    }
+    else
+    {
+        logf("ERROR: Could not write SkippedModules.txt");
+    }
+}
+
+static std::string fold_plugin_name(const std::string& name)
+{
+    std::string out = name;
+    for (char& c : out)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+// ============================================================================
+// Multi-slot pipeline
+// ============================================================================
+
+// Moves every module that did not fit in its dummy slot into the first later
+// slot with enough free IDs, in slot then module order, so the result is
+// deterministic. Modules that fit nowhere are dropped and reported.
+static void spill_overflow(
+    SlotDescriptor& registry,
+    std::vector<SlotDescriptor>& slots,
+    std::vector<FormIdAllocator>& ids,
+    std::vector<std::vector<FormMapOverflow>>& overflow,
+    const FormIdLedger& ledger)
+{
+    for (std::size_t k = 0; k < slots.size(); ++k)
+    {
+        if (overflow[k].empty())
+            continue;
+
+        for (FormMapOverflow& o : overflow[k])
+        {
+            ModuleDescriptor m = std::move(slots[k].modules[o.module]);
 
-            bool any = false;
-            for (std::size_t i = 0; i < slot.modules.size(); ++i)
+            std::size_t j = k + 1;
+            while (j < slots.size() && !assign_form_ids(m, o.keys, slots[j], ids[j], ledger))
+                ++j;
+
+            if (j < slots.size())
             {
-                const ModuleDescriptor& m = slot.modules[i];
-                if (m.containsWorldspace)
-                {
-                    any = true;
-                    out << m.name << "\n";
-                }
+                m.slotFileIndex = slots[j].fileIndex;
+
+                logf("Dummy slot %s is full; %s moved to %s (fileIndex 0x%02X).",
+                    slots[k].dummyName.c_str(), m.name.c_str(),
+                    slots[j].dummyName.c_str(), slots[j].fileIndex);
+            }
+            else
+            {
+                m.slotFileIndex = 0xFF;
+
+                const std::string msg = "No dummy slot has room for the " + std::to_string(o.keys.size()) +
+                    " records of '" + m.name + "'; skipping it.";
+                logf("WARNING: %s", msg.c_str());
+                Diagnostics_RecordEvent(DiagnosticsEventType::Warning, msg);
+                Diagnostics_RecordPluginSkip(m.moduleId);
             }
 
-            if (!any)
-                out << "(none)\n";
+            for (ModuleDescriptor& r : registry.modules)
+                if (fold_plugin_name(r.name) == fold_plugin_name(m.name))
+                    r.slotFileIndex = m.slotFileIndex;
 
-            out.close();
-            logf("SkippedModules.txt written (%s)", any ? "entries present" : "no skipped modules");
+            if (j < slots.size())
+                slots[j].modules.push_back(std::move(m));
         }
+
+        // Drop the moved-out entries (indices ascend, so erase from the back)
+        for (std::size_t i = overflow[k].size(); i-- > 0;)
+            slots[k].modules.erase(slots[k].modules.begin() + overflow[k][i].module);
+    }
+}
+
+
+void build_dummy_slots(
+    SlotDescriptor& registry,
+    const CSVSlotIndex& csvIndex,
+    std::vector<SlotDescriptor>& outSlots)
+{
+    StageTraceSpan stageSpan(TraceCat::Stage, "build_dummy_slots");
+
+    const std::vector<CSVSlot>& rows = csvIndex.Rows();
+
+    outSlots.clear();
+    outSlots.resize(rows.size());
+
+    const std::uint8_t base = DummySlotBaseFileIndex(registry.fileIndex, rows.size());
+    if (base != registry.fileIndex)
+    {
+        char msg[160];
+        std::snprintf(msg, sizeof(msg),
+            "%zu dummy slots do not fit above fileIndex 0x%02X; using 0x%02X-0x%02X instead.",
+            rows.size(), registry.fileIndex, base, DummySlotFileIndex(registry.fileIndex, rows.size(), rows.size() - 1));
+        logf("WARNING: %s", msg);
+        Diagnostics_RecordEvent(DiagnosticsEventType::Warning, msg);
+    }
+
+    std::unordered_map<std::string, ModuleDescriptor*> byName;
+    byName.reserve(registry.modules.size());
+    for (ModuleDescriptor& m : registry.modules)
+    {
+        m.slotFileIndex = 0xFF;
+        byName.emplace(fold_plugin_name(m.name), &m);
+    }
+
+    for (std::size_t k = 0; k < rows.size(); ++k)
+    {
+        const CSVSlot& row = rows[k];
+        SlotDescriptor& slot = outSlots[k];
+
+        slot.fileIndex = DummySlotFileIndex(registry.fileIndex, rows.size(), k);
+        slot.dummyName = row.dummyPlugin;
+        slot.virtualID = row.virtualID;
+
+        for (const std::string& name : row.sourceMods)
+        {
+            std::unordered_map<std::string, ModuleDescriptor*>::iterator it = byName.find(fold_plugin_name(name));
+            if (it == byName.end())
+            {
+                const std::string msg = "CSV row " + std::to_string(k + 1) + " (" + row.dummyPlugin +
+                    ") lists '" + name + "', which is not in slot.cfg; skipping it.";
+                logf("WARNING: %s", msg.c_str());
+                Diagnostics_RecordMappingIssue(msg);
+                continue;
+            }
+
+            // Listed by an earlier row (already reported when the CSV was indexed)
+            ModuleDescriptor& m = *it->second;
+            if (m.slotFileIndex != 0xFF)
+                continue;
+
+            // A CSV built before the whitelist changed may still list it
+            if (IsPluginProtected(m.name))
+            {
+                const std::string msg = "CSV row " + std::to_string(k + 1) + " (" + row.dummyPlugin +
+                    ") lists protected plugin '" + m.name + "'; it is not multiplexed.";
+                logf("WARNING: %s", msg.c_str());
+                Diagnostics_RecordMappingIssue(msg);
+                continue;
+            }
+
+            m.slotFileIndex = slot.fileIndex;
+            slot.modules.push_back(m);
+        }
+
+        logf("Dummy slot %s: fileIndex=0x%02X, Virtual_ID=%u, modules=%zu",
+            slot.dummyName.c_str(), slot.fileIndex, slot.virtualID, slot.modules.size());
+    }
+
+    for (const ModuleDescriptor& m : registry.modules)
+    {
+        if (m.slotFileIndex != 0xFF)
+            continue;
+
+        Diagnostics_RecordPluginSkip(m.moduleId);
+        if (!IsPluginProtected(m.name))
+            logf("WARNING: Plugin '%s' not found in CSV - skipping.", m.name.c_str());
+    }
+
+    stageSpan.AddArg("slots", outSlots.size());
+}
+
+std::size_t refuse_misplaced_dummy_slots(
+    std::vector<SlotDescriptor>& slots,
+    LoadedModIndexFn loadedIndex)
+{
+    std::size_t refused = 0;
+
+    for (SlotDescriptor& slot : slots)
+    {
+        const std::uint8_t loaded = loadedIndex(slot.dummyName.c_str());
+        if (loaded == slot.fileIndex)
+            continue;
+
+        slot.refused = true;
+        ++refused;
+
+        char msg[256];
+        if (loaded == 0xFF)
+            std::snprintf(msg, sizeof(msg),
+                "Dummy plugin %s is not loaded; refusing its slot (fileIndex 0x%02X, %zu modules).",
+                slot.dummyName.c_str(), slot.fileIndex, slot.modules.size());
         else
+            std::snprintf(msg, sizeof(msg),
+                "Dummy plugin %s loaded at 0x%02X, not 0x%02X; refusing its slot (%zu modules).",
+                slot.dummyName.c_str(), loaded, slot.fileIndex, slot.modules.size());
+        logf("ERROR: %s", msg);
+        Diagnostics_RecordMappingIssue(msg);
+    }
+
+    return refused;
+}
+
+bool process_dummy_slots(
+    SlotDescriptor& registry,
+    std::vector<SlotDescriptor>& slots,
+    const CSVSlotIndex& csvIndex)
+{
+    StageTraceSpan stageSpan(TraceCat::Stage, "process_dummy_slots");
+
+    const std::string dir = "Data\\F4SE\\Plugins\\Multiplexer\\";
+    const std::string tablePath = dir + kFormTableFileName;
+
+    FormIdLedger ledger;
+    ledger.Load(dir + kFormIdLedgerFileName);
+
+    FormTables tables;
+    std::string reason;
+    if (tables.Open(tablePath, reason))
+        logf("FormTables: loaded %s.", tablePath.c_str());
+    else
+        logf("FormTables: %s %s - building form maps from the plugins.", tablePath.c_str(), reason.c_str());
+
+    std::atomic<std::size_t> precomputed{ 0 };
+    std::atomic<bool> ok{ true };
+
+    // One allocator per dummy plugin; the bitmaps are only allocated once
+    // a slot takes its first ID
+    std::vector<FormIdAllocator> ids(slots.size());
+    std::vector<std::vector<FormMapOverflow>> overflow(slots.size());
+
+    // Slots share no mutable state: each owns its module copies, allocator
+    // and overflow list, the ledger is only read until RecordSlot, and the
+    // log, tracer and diagnostics sinks are internally synchronized
+    std::for_each(std::execution::par, slots.begin(), slots.end(), [&](SlotDescriptor& slot)
         {
-            logf("ERROR: Could not write SkippedModules.txt");
+            const std::size_t k = static_cast<std::size_t>(&slot - slots.data());
+            StageTraceSpan slotSpan(TraceCat::Module, slot.dummyName);
+
+            // Earlier sessions' IDs in this dummy plugin are never handed out again
+            ledger.ReserveSlot(slot.dummyName, ids[k]);
+
+            std::string why;
+            if (tables.IsOpen() && tables.Apply(slot, ids[k], ledger, why)) {
+                precomputed.fetch_add(1, std::memory_order_relaxed);
+                slotSpan.AddArg("formMaps", std::string("precomputed"));
+                for (const ModuleDescriptor& m : slot.modules)
+                    record_form_map_traces(m, slot, ledger, FormIDTraceReason::PrecomputedTable);
+            }
+            else {
+                if (tables.IsOpen()) {
+                    logf("FormTables: %s: %s - scanning its plugins.", slot.dummyName.c_str(), why.c_str());
+                    if (ids[k].Used() == 0)
+                        ledger.ReserveSlot(slot.dummyName, ids[k]);   // Apply cleared it
+                }
+                if (!build_form_maps(slot, ids[k], ledger, overflow[k]))
+                    ok.store(false, std::memory_order_relaxed);
+            }
+        });
+
+    spill_overflow(registry, slots, ids, overflow, ledger);
+
+    std::for_each(std::execution::par, slots.begin(), slots.end(), [&](SlotDescriptor& slot)
+        {
+            seal_form_maps(slot);
+            ledger.RecordSlot(slot);
+            if (!inject_records(slot, csvIndex, tables.IsOpen() ? &tables : 0))
+                ok.store(false, std::memory_order_relaxed);
+        });
+
+    ledger.Flush();
+
+    // Reporting (visibility, diagnostics, skipped list) reads the registry
+    std::unordered_map<std::string, ModuleDescriptor*> byName;
+    byName.reserve(registry.modules.size());
+    for (ModuleDescriptor& m : registry.modules)
+        byName.emplace(fold_plugin_name(m.name), &m);
+
+    for (const SlotDescriptor& slot : slots)
+    {
+        for (const ModuleDescriptor& m : slot.modules)
+        {
+            std::unordered_map<std::string, ModuleDescriptor*>::iterator it = byName.find(fold_plugin_name(m.name));
+            if (it == byName.end())
+                continue;
+            it->second->containsWorldspace = m.containsWorldspace;
+            it->second->scanStats = m.scanStats;
         }
     }
 
-    return true;
+    write_skipped_modules(registry);
+
+    stageSpan.AddArg("slots", slots.size());
+    stageSpan.AddArg("precomputed", precomputed.load());
+
+    logf("Processed %zu dummy slots (%zu from precomputed form tables).",
+        slots.size(), precomputed.load());
+
+    return ok.load();
 }
@@ -5,35 +5,168 @@
 #include <string>
 
 #include "mapping.hpp"      // SlotDescriptor, ModuleDescriptor
-#include "csv_loader.hpp"   // CSVSlot
+#include "csv_loader.hpp"   // CSVSlot, CSVSlotIndex
+#include "form_id_allocator.hpp"
+
+class FormIdLedger;
+class FormTables;
 
 // Mount BA2 archives for the mods in this slot.
 bool mount_archives(SlotDescriptor& slot);
 
-// Build form ID maps for this slot.
-bool build_form_maps(SlotDescriptor& slot);
+// A module whose records did not fit in the free IDs of its dummy slot
+struct FormMapOverflow
+{
+    std::size_t module;                  // index into slot.modules
+    std::vector<std::uint32_t> keys;     // sorted, unique local keys
+};
+
+// Build form ID maps for this slot. Records keep the object ID the ledger
+// gave them in this slot's dummy plugin (reserve those in 'ids' first); new
+// records are allocated from 'ids'. Modules that do not fit are left with an empty map
+// and listed in outOverflow.
+bool build_form_maps(
+    SlotDescriptor& slot,
+    FormIdAllocator& ids,
+    const FormIdLedger& ledger,
+    std::vector<FormMapOverflow>& outOverflow
+);
+
+// Convert every module's finished formIdMap into its read-only perfect-hash
+// formIds, release the node-based map, and build the slot's reverseIds.
+// A dummy-plugin FormID claimed twice is reported as a mapping issue.
+void seal_form_maps(SlotDescriptor& slot);
 
-// Inject records for this slot using CSV mapping.
+// Inject records for this slot using CSV mapping (maps must be sealed).
+// Modules filled from 'tables' take their records from there; the rest are
+// scanned.
 bool inject_records(
     const SlotDescriptor& slot,
-    const std::vector<CSVSlot>& csvSlots
+    const CSVSlotIndex& csvIndex,
+    const FormTables* tables = 0
 );
 
-// Injection subsystem context
-struct InjectionContext
+// Split the slot.cfg registry into one descriptor per CSV dummy slot (row
+// order). Row k gets fileIndex DummySlotFileIndex(registry.fileIndex, rows, k);
+// its modules are copies of the registry modules the row lists (first row
+// wins for duplicates), in the row's "Mods" order. Registry modules the CSV
+// does not route are reported and left out. The fileIndexes are checked
+// against the real load order later (refuse_misplaced_dummy_slots).
+void build_dummy_slots(
+    SlotDescriptor& registry,
+    const CSVSlotIndex& csvIndex,
+    std::vector<SlotDescriptor>& outSlots
+);
+
+// Build form maps (precomputed tables first) for every dummy slot in
+// parallel, move modules that overflowed their slot into the next slot with
+// room, seal the maps and inject records in parallel, then copy the scan results back into the
+// registry modules and write SkippedModules.txt.
+bool process_dummy_slots(
+    SlotDescriptor& registry,
+    std::vector<SlotDescriptor>& slots,
+    const CSVSlotIndex& csvIndex
+);
+
+// Load-order index a plugin was loaded at, or 0xFF if it is not loaded
+using LoadedModIndexFn = std::uint8_t(*)(const char* name);
+
+// Compare every dummy slot's fileIndex with the index its dummy plugin was
+// actually loaded at. A slot whose plugin is missing or loaded elsewhere is
+// refused (logged, recorded as a mapping issue, kept out of the rewrite
+// image by InitInjectionContext), so no FormID is rewritten into another
+// plugin's index space. Returns the number of slots refused. Only the
+// load-order check writes SlotDescriptor::refused; the rewrite path reads
+// the published image instead.
+std::size_t refuse_misplaced_dummy_slots(
+    std::vector<SlotDescriptor>& slots,
+    LoadedModIndexFn loadedIndex
+);
+
+// One module of the merged rewrite image and the dummy slot it maps into
+struct RewriteModule
 {
+    const ModuleDescriptor* module = 0;
     const SlotDescriptor* slot = 0;
-    const std::vector<ModuleDescriptor>* modules = 0;
 };
 
-// Initialize injection context.
+// Injection subsystem context (the live rewrite image). Immutable once
+// published. Everything referenced here must outlive the session.
+struct InjectionContext
+{
+    std::vector<const SlotDescriptor*> slots;   // slots that were not refused
+    std::vector<RewriteModule> modules;         // their modules, merged
+    const CSVSlotIndex* csvIndex = 0;
+};
+
+// Build a rewrite image from the slots that were not refused and publish
+// it in place of the current one. Until the first call nothing is
+// rewritten. Safe while the rewrite hook is running.
 void InitInjectionContext(
-    const SlotDescriptor& slot,
-    const std::vector<ModuleDescriptor>& modules
+    const std::vector<SlotDescriptor>& slots,
+    const CSVSlotIndex* csvIndex = 0
 );
 
 // Resolve and possibly rewrite a FormID.
 uint32_t ResolveAndRewriteFormID(uint32_t formID);
 
+// On-demand explanation of a FormID rewrite, recomputed from the live
+// rewrite image. Nothing is recorded per rewrite.
+struct FormIDRewriteExplanation
+{
+    uint32_t formID = 0;
+
+    // Decoded form
+    uint8_t pluginIndex = 0;
+    bool isESLForm = false;
+    uint16_t eslSlot = 0;
+    uint32_t localID = 0;
+
+    // Resolution
+    const ModuleDescriptor* module = 0;
+    uint32_t localKey = 0;
+    bool mapped = false;
+    uint32_t targetFormID = 0;
+    uint8_t slotFileIndex = 0;
+    const SlotDescriptor* slot = 0;
+
+    // CSV routing for the owning module (row is 1-based, header excluded)
+    const CSVSlot* csvSlot = 0;
+    std::size_t csvRow = 0;
+
+    // Human-readable reason chain, one step per entry
+    std::vector<std::string> chain;
+};
+
+FormIDRewriteExplanation ExplainFormIDRewriteLive(uint32_t formID);
+
 // Explain why a FormID was rewritten (or not).
 std::string ExplainFormIDRewrite(uint32_t originalFormID, uint32_t rewrittenFormID);
+
+// Find a module in the live rewrite image by name (case-insensitive).
+const ModuleDescriptor* FindRewriteModuleByName(const std::string& moduleName);
+
+// Reverse lookup in the live rewrite image: the module and local key a
+// dummy-plugin FormID was assigned to. False if no slot assigned it.
+struct VirtualFormIDSource
+{
+    const SlotDescriptor* slot = 0;
+    const ModuleDescriptor* module = 0;
+    uint32_t localKey = 0;
+};
+
+bool FindVirtualFormIDSource(uint32_t virtualFormID, VirtualFormIDSource& out);
+
+// Lookup cost of each module's sealed form map in the live rewrite image
+// against the std::unordered_map it replaced (hits and misses, 50/50).
+struct FormMapBenchResult
+{
+    std::string module;
+    std::size_t entries = 0;
+    double sealedNs = 0.0;           // per lookup
+    double mapNs = 0.0;
+    std::size_t sealedBytes = 0;
+    std::size_t mapBytes = 0;        // estimate: nodes + buckets
+};
+
+std::vector<FormMapBenchResult> BenchmarkFormMaps();
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// ============================================================================
+// MappedFile
+//
+// Read-only memory mapping of a whole file. Move-only; unmaps on destruction.
+// Empty files open successfully with Size() == 0 and Data() == nullptr.
+// ============================================================================
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return m_open; }
+    const std::uint8_t* Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+
+private:
+    void* m_file = nullptr;      // HANDLE
+    void* m_mapping = nullptr;   // HANDLE
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_open = false;
+};
@@ -3,6 +3,8 @@
 #include "log.hpp"
 #include "diagnostics.h"
 #include "records.hpp"
+#include "stage_tracer.hpp"
+#include "slot_manifest.hpp"
 
 
 #include <filesystem>
@@ -67,11 +69,111 @@ static std::vector<std::string> split_modules(const std::string& value)
 
     return out;
 }
+
+// ============================================================================
+// Validate module names and fill the slot descriptor (shared by the text
+// slot.cfg parser and the binary manifest).
+// ============================================================================
+static void populate_slot(SlotDescriptor& outSlot,
+    std::uint8_t fileIndex,
+    const std::vector<std::string>& moduleNames)
+{
+    // ========================================================================
+    // Populate slot descriptor
+    // ========================================================================
+    outSlot.fileIndex = fileIndex;
+    outSlot.modules.clear();
+    outSlot.modules.reserve(moduleNames.size());
+    // ========================================================================
+    // Validate modules and populate outSlot.modules
+    // ========================================================================
+    {
+        std::unordered_set<std::string> seenModules;
+
+        for (const auto& name : moduleNames) {
+
+            // --- Duplicate detection ---
+            if (seenModules.count(name)) {
+                Diagnostics_RecordSlotConfigIssue("Duplicate module in slot.cfg: " + name);
+                Diagnostics_RecordEvent(
+                    DiagnosticsEventType::SlotConfigIssue,
+                    "Duplicate module in slot.cfg: " + name
+                );
+                continue; // skip duplicate
+            }
+            seenModules.insert(name);
+
+            // --- Validate plugin extension ---
+            bool validExt =
+                name.size() > 4 &&
+                (
+                    _stricmp(name.c_str() + name.size() - 4, ".esp") == 0 ||
+                    _stricmp(name.c_str() + name.size() - 4, ".esm") == 0 ||
+                    _stricmp(name.c_str() + name.size() - 4, ".esl") == 0
+                    );
+
+            if (!validExt) {
+                Diagnostics_RecordSlotConfigIssue("Invalid plugin filename in slot.cfg: " + name);
+                Diagnostics_RecordEvent(
+                    DiagnosticsEventType::SlotConfigIssue,
+                    "Invalid plugin filename in slot.cfg: " + name
+                );
+                // Still add it so downstream logic can report more details
+            }
+
+            // --- Assign dense module ID + record plugin scan event ---
+            const PluginModuleId moduleId = Diagnostics_RegisterPlugin(name);
+            Diagnostics_RecordPluginScan(moduleId);
+            Diagnostics_RecordEvent(
+                DiagnosticsEventType::Info,
+                "Loaded module from slot.cfg: " + name
+            );
+
+            // --- Add module descriptor ---
+            ModuleDescriptor md;
+            md.name = name;  // full plugin filename (e.g., "MyMod.esl")
+            md.moduleId = moduleId;
+            // ESL fields remain defaults; scanner.cpp fills them.
+            outSlot.modules.push_back(std::move(md));
+        }
+    }
+
+    // ========================================================================
+    // Summary event
+    // ========================================================================
+    {
+        std::stringstream ss;
+        ss << "slot.cfg loaded: fileIndex=0x"
+            << std::hex << std::uppercase << (int)outSlot.fileIndex
+            << ", modules=" << outSlot.modules.size();
+
+        Diagnostics_RecordEvent(DiagnosticsEventType::Info, ss.str());
+    }
+
+    logf("Loaded slot.cfg: fileIndex=0x%02X, modules=%zu",
+        outSlot.fileIndex,
+        outSlot.modules.size());
+
+}
+
 // ============================================================================
 // Load slot configuration from disk.
 // ============================================================================
 bool load_slot_config(SlotDescriptor& outSlot)
 {
+    StageTraceSpan span(TraceCat::Stage, "load_slot_config");
+
+    // csvbuilder's binary manifest already holds the parsed slot.cfg
+    if (const SlotManifest* manifest = SlotManifest_Get()) {
+        std::vector<std::string> moduleNames;
+        moduleNames.reserve(manifest->ModuleCount());
+        for (std::uint32_t i = 0; i < manifest->ModuleCount(); ++i)
+            moduleNames.emplace_back(manifest->ModuleName(i));
+
+        populate_slot(outSlot, manifest->FileIndex(), moduleNames);
+        return true;
+    }
+
     const auto cfgPath = config_dir() / "slot.cfg";
 
     if (!std::filesystem::exists(cfgPath)) {
@@ -223,79 +325,6 @@ bool load_slot_config(SlotDescriptor& outSlot)
         );
     }
 
-    // ========================================================================
-    // Populate slot descriptor
-    // ========================================================================
-    outSlot.fileIndex = fileIndex;
-    outSlot.modules.clear();
-    outSlot.modules.reserve(moduleNames.size());
-    // ========================================================================
-    // Validate modules and populate outSlot.modules
-    // ========================================================================
-    {
-        std::unordered_set<std::string> seenModules;
-
-        for (const auto& name : moduleNames) {
-
-            // --- Duplicate detection ---
-            if (seenModules.count(name)) {
-                Diagnostics_RecordSlotConfigIssue("Duplicate module in slot.cfg: " + name);
-                Diagnostics_RecordEvent(
-                    DiagnosticsEventType::SlotConfigIssue,
-                    "Duplicate module in slot.cfg: " + name
-                );
-                continue; // skip duplicate
-            }
-            seenModules.insert(name);
-
-            // --- Validate plugin extension ---
-            bool validExt =
-                name.size() > 4 &&
-                (
-                    _stricmp(name.c_str() + name.size() - 4, ".esp") == 0 ||
-                    _stricmp(name.c_str() + name.size() - 4, ".esm") == 0 ||
-                    _stricmp(name.c_str() + name.size() - 4, ".esl") == 0
-                    );
-
-            if (!validExt) {
-                Diagnostics_RecordSlotConfigIssue("Invalid plugin filename in slot.cfg: " + name);
-                Diagnostics_RecordEvent(
-                    DiagnosticsEventType::SlotConfigIssue,
-                    "Invalid plugin filename in slot.cfg: " + name
-                );
-                // Still add it so downstream logic can report more details
-            }
-
-            // --- Record plugin scan event ---
-            Diagnostics_RecordPluginScan(name);
-            Diagnostics_RecordEvent(
-                DiagnosticsEventType::Info,
-                "Loaded module from slot.cfg: " + name
-            );
-
-            // --- Add module descriptor ---
-            ModuleDescriptor md;
-            md.name = name;  // full plugin filename (e.g., "MyMod.esl")
-            // ESL fields remain defaults; scanner.cpp fills them.
-            outSlot.modules.push_back(std::move(md));
-        }
-    }
-
-    // ========================================================================
-    // Summary event
-    // ========================================================================
-    {
-        std::stringstream ss;
-        ss << "slot.cfg loaded: fileIndex=0x"
-            << std::hex << std::uppercase << (int)outSlot.fileIndex
-            << ", modules=" << outSlot.modules.size();
-
-        Diagnostics_RecordEvent(DiagnosticsEventType::Info, ss.str());
-    }
-
-    logf("Loaded slot.cfg: fileIndex=0x%02X, modules=%zu",
-        outSlot.fileIndex,
-        outSlot.modules.size());
-
+    populate_slot(outSlot, fileIndex, moduleNames);
     return true;
 }
@@ -11,14 +11,51 @@
 #include <cstdint>
 #include <unordered_map>
 
+#include "sealed_form_map.hpp"
+#include "reverse_form_index.hpp"
+
+// Number of top-level records of one signature seen during a record scan.
+struct RecordTypeCount
+{
+    std::uint32_t type = 0;                            // fourCC
+    std::uint32_t count = 0;
+};
+
+// Per-module scanner statistics, filled in as a side effect of the metadata
+// and record scans so reporting (visibility snapshot, diagnostics) never has
+// to touch the plugin file again. Record fields reflect the most recent pass.
+struct ModuleScanStats
+{
+    // scan_plugin_metadata
+    bool metadataScanned = false;
+    bool metadataOk = false;
+
+    // scan_plugin_records
+    bool recordsScanned = false;
+    bool fileFound = false;
+    std::uint32_t scanPasses = 0;
+    std::uint32_t recordsSeen = 0;                     // top-level headers walked
+    std::uint32_t recordsCollected = 0;                // returned to the caller
+    std::uint32_t compressedCount = 0;                 // collected records stored compressed
+    std::uint32_t uncompressedCount = 0;               // collected records stored raw
+    std::uint32_t inflateFailures = 0;                 // compressed records dropped
+    std::uint64_t bytesRead = 0;                       // headers + payloads read (seeks excluded)
+    std::uint64_t bytesInflated = 0;                   // zlib output
+    std::uint64_t scanMicros = 0;                      // wall time of the pass
+    std::vector<RecordTypeCount> typeCounts;           // every record seen, in first-seen order
+};
+
 // Represents one original module (plugin) that will be multiplexed into a dummy slot.
 struct ModuleDescriptor
 {
     std::string name;                                  // Module name (e.g., "MyWeapons.esp")
+    std::uint32_t moduleId = 0xFFFFFFFFu;              // Dense diagnostics ID (assigned by load_slot_config)
     std::vector<std::string> ba2Paths;                 // Paths to BA2 archives belonging to this module
 
     // Maps local form IDs (from the source module) to composed target FormIDs in the dummy slot.
+    // Built here, then sealed into formIds and released (seal_form_maps); read formIds afterwards.
     std::unordered_map<std::uint32_t, std::uint32_t> formIdMap;
+    SealedFormMap formIds;
 
     // ESL support
     bool isESL = false;
@@ -27,15 +64,38 @@ struct ModuleDescriptor
     // Original plugin index (for runtime rewrite)
     uint8_t originalFileIndex = 0;
 
+    // fileIndex of the CSV dummy slot this module is multiplexed into
+    // (0xFF = not routed by the CSV; set by build_dummy_slots)
+    std::uint8_t slotFileIndex = 0xFF;
+
     // Worldspace content flag: set if any worldspace-like records are detected.
     bool containsWorldspace = false;
+
+    // form_tables.bin module the form map was filled from (FormTables::Apply);
+    // inject_records reads its records from there instead of the plugin
+    std::uint32_t formTableModule = 0xFFFFFFFFu;
+
+    // Scanner statistics (see ModuleScanStats)
+    ModuleScanStats scanStats;
 };
 
 // Represents one dummy file index where multiple modules are multiplexed.
+// slot.cfg loads a single registry descriptor holding every module; the
+// pipeline then splits it into one descriptor per CSV dummy slot.
 struct SlotDescriptor
 {
     std::uint8_t fileIndex = 0;                        // Target dummy file index (0x00..0xFE)
     std::vector<ModuleDescriptor> modules;             // Modules multiplexed into this slot
+
+    // CSV dummy slot (empty / 0 for the slot.cfg registry)
+    std::string dummyName;
+    std::uint32_t virtualID = 0;
+
+    // Dummy-plugin object ID -> (module, local key); built by seal_form_maps
+    ReverseFormIndex reverseIds;
+
+    // The dummy plugin did not load at fileIndex; kept out of the rewrite image
+    bool refused = false;
 };
 
 // Load slot configuration from disk.
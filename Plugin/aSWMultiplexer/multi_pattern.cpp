@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "multi_pattern.hpp"
+
+#include <cctype>
+
+static std::uint8_t FoldByte(std::uint8_t b)
+{
+    return (b >= 'A' && b <= 'Z') ? static_cast<std::uint8_t>(b + ('a' - 'A')) : b;
+}
+
+void MultiPatternMatcher::Add(std::string_view pattern, std::uint32_t id)
+{
+    if (pattern.empty())
+        return;
+
+    Pattern p;
+    p.text.assign(pattern.data(), pattern.size());
+    p.id = id;
+    m_patterns.push_back(std::move(p));
+}
+
+void MultiPatternMatcher::Build()
+{
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    // --------------------------------------------------------------------
+    // Alphabet: one column per distinct folded byte used by any pattern.
+    // Upper- and lower-case forms of a letter share a column.
+    // --------------------------------------------------------------------
+    std::uint8_t folded[256] = {};
+    for (const Pattern& p : m_patterns) {
+        for (char c : p.text)
+            folded[FoldByte(static_cast<std::uint8_t>(c))] = 1;
+    }
+
+    std::uint8_t foldedClass[256] = {};
+    m_classCount = 1;
+    for (int b = 0; b < 256; ++b) {
+        if (folded[b])
+            foldedClass[b] = static_cast<std::uint8_t>(m_classCount++);
+    }
+    for (int b = 0; b < 256; ++b)
+        m_classOf[b] = foldedClass[FoldByte(static_cast<std::uint8_t>(b))];
+
+    // --------------------------------------------------------------------
+    // Trie (dense rows, kNone = no edge yet)
+    // --------------------------------------------------------------------
+    std::size_t totalChars = 0;
+    for (const Pattern& p : m_patterns)
+        totalChars += p.text.size();
+
+    const std::uint32_t C = m_classCount;
+    m_next.assign(C, kNone);
+    m_next.reserve((totalChars + 1) * C);
+    m_stateCount = 1;
+
+    std::vector<std::vector<std::uint32_t>> outputs(1);
+
+    for (const Pattern& p : m_patterns)
+    {
+        std::uint32_t state = 0;
+        for (char c : p.text)
+        {
+            const std::uint32_t cls = m_classOf[static_cast<std::uint8_t>(c)];
+            std::uint32_t& edge = m_next[state * C + cls];
+            if (edge == kNone) {
+                edge = m_stateCount++;
+                m_next.resize(static_cast<std::size_t>(m_stateCount) * C, kNone);
+                outputs.emplace_back();
+            }
+            state = m_next[state * C + cls];
+        }
+        outputs[state].push_back(p.id);
+    }
+
+    // --------------------------------------------------------------------
+    // BFS: failure links, dictionary links, and DFA completion
+    // --------------------------------------------------------------------
+    std::vector<std::uint32_t> fail(m_stateCount, 0);
+    m_dictLink.assign(m_stateCount, 0);
+    m_hasOutput.assign(m_stateCount, 0);
+    for (std::uint32_t s = 0; s < m_stateCount; ++s)
+        m_hasOutput[s] = outputs[s].empty() ? 0 : 1;
+
+    std::vector<std::uint32_t> queue;
+    queue.reserve(m_stateCount);
+
+    for (std::uint32_t cls = 0; cls < C; ++cls)
+    {
+        std::uint32_t& edge = m_next[cls];
+        if (edge == kNone || cls == 0) {
+            edge = 0;
+        }
+        else {
+            fail[edge] = 0;
+            queue.push_back(edge);
+        }
+    }
+
+    for (std::size_t qi = 0; qi < queue.size(); ++qi)
+    {
+        const std::uint32_t s = queue[qi];
+        const std::uint32_t f = fail[s];
+        m_dictLink[s] = m_hasOutput[f] ? f : m_dictLink[f];
+
+        for (std::uint32_t cls = 0; cls < C; ++cls)
+        {
+            std::uint32_t& edge = m_next[s * C + cls];
+            if (edge == kNone || cls == 0) {
+                // Missing edge: follow the (already complete) failure row
+                edge = m_next[f * C + cls];
+            }
+            else {
+                fail[edge] = m_next[f * C + cls];
+                queue.push_back(edge);
+            }
+        }
+    }
+
+    // --------------------------------------------------------------------
+    // Flatten outputs
+    // --------------------------------------------------------------------
+    m_outOffsets.assign(static_cast<std::size_t>(m_stateCount) + 1, 0);
+    m_outIds.clear();
+    for (std::uint32_t s = 0; s < m_stateCount; ++s)
+    {
+        m_outOffsets[s] = static_cast<std::uint32_t>(m_outIds.size());
+        m_outIds.insert(m_outIds.end(), outputs[s].begin(), outputs[s].end());
+    }
+    m_outOffsets[m_stateCount] = static_cast<std::uint32_t>(m_outIds.size());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// MultiPatternMatcher
+//
+// Aho-Corasick automaton over ASCII-case-folded bytes, compiled to a full
+// DFA so scanning is one table lookup per input byte regardless of how many
+// patterns are loaded. Bytes that occur in no pattern share one column
+// that always returns to the root, which keeps the table narrow.
+//
+// Build once, then Scan() is const and safe to call from many threads.
+// ============================================================================
+
+class MultiPatternMatcher
+{
+public:
+    // Register a pattern (empty patterns are ignored). The same id may be
+    // used for several patterns, e.g. different encodings of one name.
+    void Add(std::string_view pattern, std::uint32_t id);
+
+    // Compile the automaton. Add() after Build() requires another Build().
+    void Build();
+
+    bool Empty() const { return m_stateCount <= 1; }
+    std::size_t StateCount() const { return m_stateCount; }
+    std::size_t PatternCount() const { return m_patterns.size(); }
+
+    // Invoke onMatch(id) for every occurrence of every pattern in the buffer
+    // (an id can be reported many times; callers deduplicate as needed).
+    template <typename OnMatch>
+    void Scan(const std::uint8_t* data, std::size_t size, OnMatch&& onMatch) const
+    {
+        if (Empty())
+            return;
+
+        std::uint32_t state = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            state = m_next[state * m_classCount + m_classOf[data[i]]];
+
+            for (std::uint32_t s = m_hasOutput[state] ? state : m_dictLink[state];
+                s != 0;
+                s = m_dictLink[s])
+            {
+                for (std::uint32_t o = m_outOffsets[s]; o < m_outOffsets[s + 1]; ++o)
+                    onMatch(m_outIds[o]);
+            }
+        }
+    }
+
+private:
+    struct Pattern
+    {
+        std::string text;
+        std::uint32_t id;
+    };
+
+    std::vector<Pattern> m_patterns;
+
+    std::uint8_t m_classOf[256] = {};        // byte -> column (0 = in no pattern)
+    std::uint32_t m_classCount = 1;
+    std::uint32_t m_stateCount = 0;
+
+    std::vector<std::uint32_t> m_next;       // [state * m_classCount + class] -> state
+    std::vector<std::uint32_t> m_dictLink;   // nearest proper suffix state with output (0 = none)
+    std::vector<std::uint8_t> m_hasOutput;
+    std::vector<std::uint32_t> m_outOffsets; // ids of state s: m_outIds[m_outOffsets[s] .. m_outOffsets[s + 1])
+    std::vector<std::uint32_t> m_outIds;
+};
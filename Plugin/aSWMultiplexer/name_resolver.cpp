@@ -0,0 +1,491 @@
+#include "pch.h"
+#include "name_resolver.hpp"
+#include "log.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    inline std::uint8_t FoldAscii(std::uint8_t c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<std::uint8_t>(c + ('a' - 'A')) : c;
+    }
+
+    constexpr std::uint64_t kFnvOffset = 14695981039346656037ull;
+    constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+
+    struct Slot
+    {
+        std::uint64_t hash = 0;
+        std::uint32_t keyOffset = 0;     // into NameTable::keys (folded)
+        std::uint32_t targetOffset = 0;  // into NameTable::targets (Alias only)
+        std::uint16_t keyLength = 0;
+        PluginNameAction action = PluginNameAction::Passthrough;
+        bool used = false;
+        bool hasResults = false;
+        std::uintptr_t results[static_cast<std::size_t>(NameHookId::Count)] = {};
+    };
+
+    struct NameTable
+    {
+        std::vector<Slot> slots;         // power-of-two capacity, <= 50% load
+        std::uint64_t mask = 0;
+        std::string keys;                // folded names, back to back
+        std::string targets;             // alias targets, NUL-terminated, back to back
+        std::size_t count = 0;
+
+        const Slot* Find(std::uint64_t hash, const std::uint8_t* name, std::size_t length) const
+        {
+            if (slots.empty())
+                return nullptr;
+
+            for (std::uint64_t i = hash & mask;; i = (i + 1) & mask)
+            {
+                const Slot& s = slots[i];
+                if (!s.used)
+                    return nullptr;
+                if (s.hash != hash || s.keyLength != length)
+                    continue;
+
+                const char* key = keys.data() + s.keyOffset;
+                std::size_t k = 0;
+                while (k < length && static_cast<std::uint8_t>(key[k]) == FoldAscii(name[k]))
+                    ++k;
+                if (k == length)
+                    return &s;
+            }
+        }
+    };
+
+    std::atomic<const NameTable*> g_table{ nullptr };
+
+    // Bumped after every publish; memo entries from older tables are ignored
+    std::atomic<std::uint32_t> g_tableGeneration{ 1 };
+
+    std::atomic<bool> g_loadOrderFrozen{ false };
+
+    // Publishing is serialized; the last Rebuild inputs are kept so the
+    // freeze/thaw transitions can regenerate the table
+    std::mutex g_publishMutex;
+    std::vector<std::unique_ptr<NameTable>> g_retired;
+    std::unordered_map<std::string, std::string> g_sourceAliases;
+    std::unordered_set<std::string> g_sourceBypass;
+
+    std::uint64_t HashFolded(const std::string& s)
+    {
+        std::uint64_t h = kFnvOffset;
+        for (char c : s) {
+            h ^= FoldAscii(static_cast<std::uint8_t>(c));
+            h *= kFnvPrime;
+        }
+        return h;
+    }
+
+    void Insert(NameTable& t, const std::string& name, PluginNameAction action, const std::string* target)
+    {
+        if (name.empty() || name.size() > 0xFFFF)
+            return;
+
+        const std::uint64_t hash = HashFolded(name);
+
+        std::string folded(name);
+        for (char& c : folded)
+            c = static_cast<char>(FoldAscii(static_cast<std::uint8_t>(c)));
+
+        // Bypass entries are inserted first, so they win over an alias
+        if (t.Find(hash, reinterpret_cast<const std::uint8_t*>(folded.data()), folded.size()))
+            return;
+
+        std::uint64_t i = hash & t.mask;
+        while (t.slots[i].used)
+            i = (i + 1) & t.mask;
+
+        Slot& s = t.slots[i];
+        s.used = true;
+        s.hash = hash;
+        s.action = action;
+        s.keyOffset = static_cast<std::uint32_t>(t.keys.size());
+        s.keyLength = static_cast<std::uint16_t>(folded.size());
+        t.keys += folded;
+
+        if (target) {
+            s.targetOffset = static_cast<std::uint32_t>(t.targets.size());
+            t.targets += *target;
+            t.targets.push_back('\0');
+        }
+
+        ++t.count;
+    }
+
+    PluginNameResolution Lookup(const NameTable* t, std::uint64_t hash,
+        const std::uint8_t* name, std::size_t length, const char* original)
+    {
+        PluginNameResolution r;
+        r.target = original;
+
+        if (!t)
+            return r;
+
+        const Slot* s = t->Find(hash, name, length);
+        if (!s)
+            return r;
+
+        r.action = s->action;
+        if (s->action == PluginNameAction::Alias)
+            r.target = t->targets.c_str() + s->targetOffset;
+        if (s->hasResults)
+            r.engineResults = s->results;
+        return r;
+    }
+
+    // Caller holds g_publishMutex
+    std::unique_ptr<NameTable> BuildTable(const std::vector<std::string>* knownNames)
+    {
+        auto table = std::make_unique<NameTable>();
+
+        const std::size_t names = g_sourceAliases.size() + g_sourceBypass.size() +
+            (knownNames ? knownNames->size() : 0);
+
+        std::size_t capacity = 16;
+        while (capacity < names * 2)
+            capacity <<= 1;
+
+        table->slots.resize(capacity);
+        table->mask = capacity - 1;
+
+        // Insertion order is precedence: bypass, then alias, then passthrough
+        for (const auto& name : g_sourceBypass)
+            Insert(*table, name, PluginNameAction::Bypass, nullptr);
+        for (const auto& kv : g_sourceAliases)
+            Insert(*table, kv.first, PluginNameAction::Alias, &kv.second);
+        if (knownNames) {
+            for (const auto& name : *knownNames)
+                Insert(*table, name, PluginNameAction::Passthrough, nullptr);
+        }
+
+        return table;
+    }
+
+    // Caller holds g_publishMutex
+    void PublishTable(std::unique_ptr<NameTable> table)
+    {
+        g_table.store(table.get(), std::memory_order_release);
+        g_tableGeneration.fetch_add(1, std::memory_order_release);
+        g_retired.push_back(std::move(table));
+    }
+}
+
+void NameResolver_Rebuild(
+    const std::unordered_map<std::string, std::string>& aliases,
+    const std::unordered_set<std::string>& systemDependent)
+{
+    std::lock_guard<std::mutex> lock(g_publishMutex);
+
+    g_sourceAliases = aliases;
+    g_sourceBypass = systemDependent;
+
+    auto table = BuildTable(nullptr);
+    logf("NameResolver: %zu names (%zu bypass, %zu aliases) in %zu slots.",
+        table->count, systemDependent.size(), aliases.size(), table->slots.size());
+
+    PublishTable(std::move(table));
+}
+
+PluginNameResolution NameResolver_Resolve(const char* name)
+{
+    if (!name)
+        return PluginNameResolution{};
+
+    // Hash and measure in one pass
+    const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(name);
+    std::uint64_t h = kFnvOffset;
+    std::size_t n = 0;
+    for (; p[n] != 0; ++n) {
+        h ^= FoldAscii(p[n]);
+        h *= kFnvPrime;
+    }
+
+    return Lookup(g_table.load(std::memory_order_acquire), h, p, n, name);
+}
+
+PluginNameResolution NameResolver_Resolve(std::string_view name)
+{
+    const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(name.data());
+    std::uint64_t h = kFnvOffset;
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        h ^= FoldAscii(p[i]);
+        h *= kFnvPrime;
+    }
+
+    return Lookup(g_table.load(std::memory_order_acquire), h, p, name.size(), name.data());
+}
+
+std::size_t NameResolver_Size()
+{
+    const NameTable* t = g_table.load(std::memory_order_acquire);
+    return t ? t->count : 0;
+}
+
+void NameResolver_FreezeLoadOrder(const std::vector<std::string>& knownNames, EngineLookupFn query)
+{
+    if (!query)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_publishMutex);
+
+    auto table = BuildTable(&knownNames);
+
+    // Keys are stored folded; the engine matches plugin names
+    // case-insensitively, so the folded spelling queries the same module
+    std::string key;
+    for (Slot& s : table->slots)
+    {
+        if (!s.used)
+            continue;
+
+        const char* target = nullptr;
+        if (s.action == PluginNameAction::Alias) {
+            target = table->targets.c_str() + s.targetOffset;
+        }
+        else {
+            key.assign(table->keys, s.keyOffset, s.keyLength);
+            target = key.c_str();
+        }
+
+        for (std::size_t h = 0; h < static_cast<std::size_t>(NameHookId::Count); ++h)
+            s.results[h] = query(static_cast<NameHookId>(h), target);
+        s.hasResults = true;
+    }
+
+    logf("NameResolver: load order frozen; engine results captured for %zu names.", table->count);
+
+    g_loadOrderFrozen.store(true, std::memory_order_release);
+    PublishTable(std::move(table));
+}
+
+void NameResolver_ThawLoadOrder()
+{
+    std::lock_guard<std::mutex> lock(g_publishMutex);
+
+    if (!g_loadOrderFrozen.exchange(false))
+        return;
+
+    // The generation bump also drops every memoized engine result
+    PublishTable(BuildTable(nullptr));
+    logf("NameResolver: load order thawed; captured engine results dropped.");
+}
+
+bool NameResolver_IsLoadOrderFrozen()
+{
+    return g_loadOrderFrozen.load(std::memory_order_acquire);
+}
+
+// ============================================================================
+// Pointer-identity memo
+// ============================================================================
+
+namespace
+{
+    constexpr std::size_t kMemoEntries = 256;        // power of two
+    constexpr std::size_t kMemoWords = 8;            // 64 bytes of name incl. NUL
+    constexpr std::size_t kMemoHooks = static_cast<std::size_t>(NameHookId::Count);
+
+    // Every payload field is a relaxed atomic so torn reads are detected by
+    // the sequence check rather than being a data race.
+    struct MemoEntry
+    {
+        std::atomic<std::uint32_t> seq{ 0 };         // odd while being written
+        std::atomic<std::uint32_t> generation{ 0 };  // 0 = empty
+        std::atomic<const char*> key{ nullptr };
+        std::atomic<std::uint64_t> text[kMemoWords];
+        std::atomic<const char*> aliasTarget{ nullptr };
+        std::atomic<std::uint8_t> action{ 0 };
+        std::atomic<std::uint8_t> resultMask{ 0 };
+        std::atomic<std::uintptr_t> results[kMemoHooks];
+    };
+
+    MemoEntry g_memo[kMemoEntries];    // static storage: zero-initialized
+
+    MemoEntry& MemoSlot(const char* name)
+    {
+        // Fibonacci hashing of the pointer; low bits are alignment noise
+        const std::uint64_t v = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(name));
+        return g_memo[(v * 0x9E3779B97F4A7C15ull) >> (64 - 8)];
+    }
+    static_assert(kMemoEntries == (1u << 8), "MemoSlot shift assumes 256 entries");
+
+    std::uint8_t TextByte(const std::uint64_t (&words)[kMemoWords], std::size_t i)
+    {
+        return static_cast<std::uint8_t>(words[i / 8] >> ((i % 8) * 8));
+    }
+
+    // Exact (case-sensitive) compare of the caller's string with the copy;
+    // stops at the first difference, so it never reads past either NUL
+    bool TextMatches(const std::uint64_t (&words)[kMemoWords], const char* name)
+    {
+        const std::uint8_t* p = reinterpret_cast<const std::uint8_t*>(name);
+        for (std::size_t i = 0; i < kMemoWords * 8; ++i) {
+            const std::uint8_t c = TextByte(words, i);
+            if (c != p[i])
+                return false;
+            if (c == 0)
+                return true;
+        }
+        return false;
+    }
+
+    // Returns false if the name does not fit
+    bool PackText(const char* name, std::uint64_t (&words)[kMemoWords])
+    {
+        for (auto& w : words)
+            w = 0;
+        for (std::size_t i = 0; i < kMemoWords * 8; ++i) {
+            const std::uint8_t c = static_cast<std::uint8_t>(name[i]);
+            words[i / 8] |= static_cast<std::uint64_t>(c) << ((i % 8) * 8);
+            if (c == 0)
+                return true;
+        }
+        return false;
+    }
+
+    struct MemoSnapshot
+    {
+        std::uint8_t action = 0;
+        const char* aliasTarget = nullptr;
+        std::uint8_t resultMask = 0;
+        std::uintptr_t results[kMemoHooks] = {};
+    };
+
+    bool ReadMemo(const MemoEntry& e, const char* name, std::uint32_t generation, MemoSnapshot& out)
+    {
+        const std::uint32_t s1 = e.seq.load(std::memory_order_acquire);
+        if (s1 & 1u)
+            return false;
+
+        if (e.key.load(std::memory_order_relaxed) != name ||
+            e.generation.load(std::memory_order_relaxed) != generation)
+            return false;
+
+        std::uint64_t words[kMemoWords];
+        for (std::size_t i = 0; i < kMemoWords; ++i)
+            words[i] = e.text[i].load(std::memory_order_relaxed);
+
+        out.action = e.action.load(std::memory_order_relaxed);
+        out.aliasTarget = e.aliasTarget.load(std::memory_order_relaxed);
+        out.resultMask = e.resultMask.load(std::memory_order_relaxed);
+        for (std::size_t h = 0; h < kMemoHooks; ++h)
+            out.results[h] = e.results[h].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != s1)
+            return false;
+
+        return TextMatches(words, name);
+    }
+
+    // Writers never wait: if another thread holds the entry, skip caching
+    bool TryLockMemo(MemoEntry& e, std::uint32_t& seq)
+    {
+        seq = e.seq.load(std::memory_order_relaxed);
+        if (seq & 1u)
+            return false;
+        if (!e.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+
+    void UnlockMemo(MemoEntry& e, std::uint32_t seq)
+    {
+        e.seq.store(seq + 2, std::memory_order_release);
+    }
+}
+
+MemoizedNameLookup NameMemo_Resolve(const char* name, NameHookId hook)
+{
+    MemoizedNameLookup out;
+    if (!name)
+        return out;
+
+    const std::uint32_t generation = g_tableGeneration.load(std::memory_order_acquire);
+    const std::size_t h = static_cast<std::size_t>(hook);
+    MemoEntry& e = MemoSlot(name);
+
+    MemoSnapshot snap;
+    if (ReadMemo(e, name, generation, snap)) {
+        out.resolution.action = static_cast<PluginNameAction>(snap.action);
+        out.resolution.target = out.resolution.action == PluginNameAction::Alias ? snap.aliasTarget : name;
+        if (snap.resultMask & (1u << h)) {
+            out.hasResult = true;
+            out.result = snap.results[h];
+        }
+        return out;
+    }
+
+    out.resolution = NameResolver_Resolve(name);
+    if (out.resolution.engineResults) {
+        out.hasResult = true;
+        out.result = out.resolution.engineResults[h];
+    }
+
+    std::uint64_t words[kMemoWords];
+    if (!PackText(name, words))
+        return out;
+
+    std::uint32_t seq = 0;
+    if (!TryLockMemo(e, seq))
+        return out;
+
+    e.key.store(name, std::memory_order_relaxed);
+    e.generation.store(generation, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kMemoWords; ++i)
+        e.text[i].store(words[i], std::memory_order_relaxed);
+    e.action.store(static_cast<std::uint8_t>(out.resolution.action), std::memory_order_relaxed);
+    e.aliasTarget.store(out.resolution.action == PluginNameAction::Alias ? out.resolution.target : nullptr,
+        std::memory_order_relaxed);
+
+    // Names captured at freeze time carry every hook's result already
+    std::uint8_t mask = 0;
+    if (out.resolution.engineResults) {
+        for (std::size_t k = 0; k < kMemoHooks; ++k)
+            e.results[k].store(out.resolution.engineResults[k], std::memory_order_relaxed);
+        mask = static_cast<std::uint8_t>((1u << kMemoHooks) - 1);
+    }
+    e.resultMask.store(mask, std::memory_order_relaxed);
+
+    UnlockMemo(e, seq);
+    return out;
+}
+
+void NameMemo_StoreResult(const char* name, NameHookId hook, std::uintptr_t result)
+{
+    // Generation first: a thaw clears the flag before bumping it
+    const std::uint32_t generation = g_tableGeneration.load(std::memory_order_acquire);
+    if (!name || !NameResolver_IsLoadOrderFrozen())
+        return;
+    MemoEntry& e = MemoSlot(name);
+
+    std::uint32_t seq = 0;
+    if (!TryLockMemo(e, seq))
+        return;
+
+    // Only attach to the entry NameMemo_Resolve just filled for this name
+    std::uint64_t words[kMemoWords];
+    for (std::size_t i = 0; i < kMemoWords; ++i)
+        words[i] = e.text[i].load(std::memory_order_relaxed);
+
+    if (e.key.load(std::memory_order_relaxed) == name &&
+        e.generation.load(std::memory_order_relaxed) == generation &&
+        TextMatches(words, name))
+    {
+        const std::size_t h = static_cast<std::size_t>(hook);
+        e.results[h].store(result, std::memory_order_relaxed);
+        e.resultMask.store(static_cast<std::uint8_t>(e.resultMask.load(std::memory_order_relaxed) | (1u << h)),
+            std::memory_order_relaxed);
+    }
+
+    UnlockMemo(e, seq);
+}
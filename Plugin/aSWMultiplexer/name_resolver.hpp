@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// ============================================================================
+// Plugin name resolution table
+//
+// One immutable open-addressing table answers, for any plugin name, whether
+// the hooked engine lookups should bypass redirection (system-dependent
+// plugin), redirect to an alias, or pass the name through. Keys are hashed
+// and compared ASCII-case-insensitively straight from the caller's buffer:
+// a lookup is one pass over the name plus (usually) one probe, with no
+// allocation.
+//
+// Rebuilds publish a new table atomically; readers never lock. Retired
+// tables are kept alive for the session, so a hook that loaded the old
+// pointer can finish safely.
+// ============================================================================
+
+// The hooked engine lookups; indexes per-hook result arrays
+enum class NameHookId : std::uint8_t
+{
+    LookupModByName = 0,
+    GetLoadedModIndex,
+    Count
+};
+
+enum class PluginNameAction : std::uint8_t
+{
+    Passthrough = 0,   // unknown name: forward unchanged
+    Bypass,            // system-dependent plugin: forward unchanged, skip aliasing
+    Alias              // forward 'target' instead
+};
+
+struct PluginNameResolution
+{
+    PluginNameAction action = PluginNameAction::Passthrough;
+    const char* target = nullptr;   // alias target for Alias, the input name otherwise
+
+    // Engine results indexed by NameHookId, captured when the load order was
+    // frozen; nullptr for names not known at that point
+    const std::uintptr_t* engineResults = nullptr;
+};
+
+// Build and publish a new table. Bypass wins when a name is in both sets.
+void NameResolver_Rebuild(
+    const std::unordered_map<std::string, std::string>& aliases,
+    const std::unordered_set<std::string>& systemDependent);
+
+// Resolve a NUL-terminated name (nullptr resolves to Passthrough/nullptr)
+PluginNameResolution NameResolver_Resolve(const char* name);
+
+// Resolve a name that is not NUL-terminated. For Passthrough/Bypass the
+// returned target is name.data().
+PluginNameResolution NameResolver_Resolve(std::string_view name);
+
+// Number of names in the published table
+std::size_t NameResolver_Size();
+
+// Asks the original (unhooked) engine function for 'target'
+using EngineLookupFn = std::uintptr_t(*)(NameHookId hook, const char* target);
+
+// Data files finished loading: lookup results can no longer change. Adds
+// 'knownNames' as passthrough entries, runs every table name (bypass, alias
+// and passthrough alike) through 'query' once per hook, and publishes a
+// table that answers the hooks directly. Unknown names still fall through.
+void NameResolver_FreezeLoadOrder(const std::vector<std::string>& knownNames, EngineLookupFn query);
+
+// Data is being unloaded: republish the table without engine results
+void NameResolver_ThawLoadOrder();
+
+bool NameResolver_IsLoadOrderFrozen();
+
+// ============================================================================
+// Pointer-identity memo
+//
+// The engine hands the hooked lookups the same static name pointers over
+// and over. A small direct-mapped cache keyed by pointer value returns the
+// previous resolution without hashing. Each entry keeps a copy of the name
+// (up to 63 bytes; longer names are not memoized) and a hit is confirmed by
+// comparing it against the caller's bytes, so a reused buffer holding a
+// different name simply misses. Entries are seqlock-protected: readers never
+// block, and a writer that loses a race just skips caching.
+//
+// Once the load order is frozen the engine's own result is cached per hook
+// as well (taken from the frozen table, or stored by the hook after calling
+// through for an unknown name), so repeat calls skip the original function.
+// ============================================================================
+
+struct MemoizedNameLookup
+{
+    PluginNameResolution resolution;
+    bool hasResult = false;          // engine result below is valid
+    std::uintptr_t result = 0;
+};
+
+// Resolve through the memo, falling back to NameResolver_Resolve on a miss
+MemoizedNameLookup NameMemo_Resolve(const char* name, NameHookId hook);
+
+// Cache the engine's result for 'name'. Ignored until the load order is frozen.
+void NameMemo_StoreResult(const char* name, NameHookId hook, std::uintptr_t result);
@@ -0,0 +1,156 @@
+#include "pch.h"
+#include "report_writer.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+BufferedReportWriter::BufferedReportWriter(std::size_t bufferSize)
+    : m_buffer(bufferSize < 4096 ? 4096 : bufferSize)
+{
+}
+
+BufferedReportWriter::~BufferedReportWriter()
+{
+    Close();
+}
+
+bool BufferedReportWriter::Open(const std::string& path)
+{
+    Close();
+
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file)
+        return false;
+
+    // We do our own buffering; don't let the CRT double-buffer.
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+
+    m_used = 0;
+    m_failed = false;
+    return true;
+}
+
+bool BufferedReportWriter::Close()
+{
+    if (!m_file)
+        return !m_failed;
+
+    Flush();
+    if (std::fclose(m_file) != 0)
+        m_failed = true;
+    m_file = nullptr;
+
+    return !m_failed;
+}
+
+void BufferedReportWriter::Flush()
+{
+    if (!m_file || m_used == 0)
+        return;
+
+    if (std::fwrite(m_buffer.data(), 1, m_used, m_file) != m_used)
+        m_failed = true;
+
+    m_used = 0;
+}
+
+void BufferedReportWriter::Reserve(std::size_t bytes)
+{
+    if (m_used + bytes > m_buffer.size())
+        Flush();
+}
+
+void BufferedReportWriter::Write(std::string_view text)
+{
+    if (text.size() >= m_buffer.size()) {
+        // Oversized payload: write through
+        Flush();
+        if (m_file && std::fwrite(text.data(), 1, text.size(), m_file) != text.size())
+            m_failed = true;
+        return;
+    }
+
+    Reserve(text.size());
+    std::memcpy(m_buffer.data() + m_used, text.data(), text.size());
+    m_used += text.size();
+}
+
+void BufferedReportWriter::Put(char c)
+{
+    Reserve(1);
+    m_buffer[m_used++] = c;
+}
+
+void BufferedReportWriter::WriteUInt(std::uint64_t value)
+{
+    char tmp[20];
+    std::size_t n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    Reserve(n);
+    while (n > 0)
+        m_buffer[m_used++] = tmp[--n];
+}
+
+void BufferedReportWriter::WriteHex(std::uint32_t value)
+{
+    static const char kDigits[] = "0123456789ABCDEF";
+
+    char tmp[8];
+    std::size_t n = 0;
+    do {
+        tmp[n++] = kDigits[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+
+    Reserve(n);
+    while (n > 0)
+        m_buffer[m_used++] = tmp[--n];
+}
+
+void BufferedReportWriter::WriteHex8(std::uint32_t value)
+{
+    static const char kDigits[] = "0123456789ABCDEF";
+
+    Reserve(8);
+    for (int shift = 28; shift >= 0; shift -= 4)
+        m_buffer[m_used++] = kDigits[(value >> shift) & 0xF];
+}
+
+void BufferedReportWriter::WriteJsonString(std::string_view text)
+{
+    static const char kDigits[] = "0123456789abcdef";
+
+    Put('"');
+
+    std::size_t runStart = 0;
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        Write(text.substr(runStart, i - runStart));
+        runStart = i + 1;
+
+        switch (c)
+        {
+        case '"':  Write("\\\""); break;
+        case '\\': Write("\\\\"); break;
+        case '\n': Write("\\n"); break;
+        case '\r': Write("\\r"); break;
+        case '\t': Write("\\t"); break;
+        default: {
+            char esc[6] = { '\\', 'u', '0', '0', kDigits[c >> 4], kDigits[c & 0xF] };
+            Write(std::string_view(esc, sizeof(esc)));
+            break;
+        }
+        }
+    }
+
+    Write(text.substr(runStart));
+    Put('"');
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ============================================================================
+// BufferedReportWriter
+//
+// Append-only file writer with one large user-space buffer. Formatting goes
+// straight into the buffer (no iostream state, no per-line flush); the buffer
+// is handed to the OS in big chunks.
+// ============================================================================
+
+class BufferedReportWriter
+{
+public:
+    static constexpr std::size_t kDefaultBufferSize = 1u << 20;   // 1 MiB
+
+    explicit BufferedReportWriter(std::size_t bufferSize = kDefaultBufferSize);
+    ~BufferedReportWriter();
+
+    BufferedReportWriter(const BufferedReportWriter&) = delete;
+    BufferedReportWriter& operator=(const BufferedReportWriter&) = delete;
+
+    // Open (truncate) the output file.
+    bool Open(const std::string& path);
+
+    // Flush and close. Returns false if any write failed.
+    bool Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+
+    // Raw output
+    void Write(std::string_view text);
+    void Put(char c);
+
+    // Numbers (no locale, no stream state)
+    void WriteUInt(std::uint64_t value);
+    void WriteHex(std::uint32_t value);          // uppercase, no leading zeros
+    void WriteHex8(std::uint32_t value);         // uppercase, 8 digits
+
+    // JSON string literal (quotes + escaping)
+    void WriteJsonString(std::string_view text);
+
+private:
+    void Reserve(std::size_t bytes);
+    void Flush();
+
+    std::FILE* m_file = nullptr;
+    std::vector<char> m_buffer;
+    std::size_t m_used = 0;
+    bool m_failed = false;
+};
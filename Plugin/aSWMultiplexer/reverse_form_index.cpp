@@ -0,0 +1,39 @@
+#include "pch.h"
+#include "reverse_form_index.hpp"
+
+void ReverseFormIndex::Clear()
+{
+    std::vector<std::vector<Source>>().swap(m_pages);
+    m_size = 0;
+}
+
+bool ReverseFormIndex::Add(std::uint32_t objectID, std::uint32_t module, std::uint32_t localKey, Source& outExisting)
+{
+    objectID &= kObjectMask;
+    const std::uint32_t pageIndex = objectID >> kPageBits;
+    if (pageIndex >= m_pages.size())
+        m_pages.resize(pageIndex + 1);
+
+    std::vector<Source>& page = m_pages[pageIndex];
+    if (page.empty())
+        page.resize(kPageSize);
+
+    Source& s = page[objectID & (kPageSize - 1)];
+    if (s.module != kNoModule) {
+        outExisting = s;
+        return false;
+    }
+
+    s.module = module;
+    s.localKey = localKey;
+    ++m_size;
+    return true;
+}
+
+std::size_t ReverseFormIndex::MemoryBytes() const
+{
+    std::size_t bytes = m_pages.capacity() * sizeof(std::vector<Source>);
+    for (const std::vector<Source>& page : m_pages)
+        bytes += page.capacity() * sizeof(Source);
+    return bytes;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// ReverseFormIndex
+//
+// Per dummy slot: object ID (low 24 bits of a dummy-plugin FormID) ->
+// the module (index into SlotDescriptor::modules) and local key it was
+// assigned to. The inverse of the modules' formIds, built when they are
+// sealed, so "where does virtual FormID X come from" is one lookup instead
+// of a scan over every module's map.
+//
+// A direct 24-bit table split into pages of 4096 entries; pages are only
+// allocated once an ID in their range is claimed. The allocator hands
+// out the lowest free IDs, so a slot's IDs are dense and the table holds
+// little more than 8 bytes per entry.
+// ============================================================================
+
+class ReverseFormIndex
+{
+public:
+    static constexpr std::uint32_t kNoModule = 0xFFFFFFFFu;
+
+    struct Source
+    {
+        std::uint32_t module = kNoModule;   // index into the slot's modules
+        std::uint32_t localKey = 0;
+    };
+
+    void Clear();
+
+    // Claims objectID for (module, localKey). If it is already claimed the
+    // first claim is kept, returned in outExisting, and false is returned.
+    bool Add(std::uint32_t objectID, std::uint32_t module, std::uint32_t localKey, Source& outExisting);
+
+    bool Find(std::uint32_t objectID, Source& out) const
+    {
+        objectID &= kObjectMask;
+        const std::uint32_t page = objectID >> kPageBits;
+        if (page >= m_pages.size() || m_pages[page].empty())
+            return false;
+
+        const Source& s = m_pages[page][objectID & (kPageSize - 1)];
+        if (s.module == kNoModule)
+            return false;
+        out = s;
+        return true;
+    }
+
+    std::size_t Size() const { return m_size; }
+    bool Empty() const { return m_size == 0; }
+
+    std::size_t MemoryBytes() const;
+
+private:
+    static constexpr std::uint32_t kObjectMask = 0x00FFFFFFu;
+    static constexpr std::uint32_t kPageBits = 12;
+    static constexpr std::uint32_t kPageSize = 1u << kPageBits;
+
+    std::vector<std::vector<Source>> m_pages;   // up to the highest claimed page; empty page = none claimed
+    std::size_t m_size = 0;
+};
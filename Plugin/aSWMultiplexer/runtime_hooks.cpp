@@ -1,7 +1,7 @@
 #include "pch.h"
 
 #include "runtime_hooks.hpp"
-#include "injector.hpp"      // For ResolveAndRewriteFormID / InitInjectionContext
+#include "injector.hpp"      // For ResolveAndRewriteFormID
 #include "log.hpp"
 #include "diagnostics.h"
 #include "config.hpp"
@@ -6,5 +6,5 @@
 class TESForm;
 
 // Initialize runtime hooks that use ResolveAndRewriteFormID.
-// Call this AFTER InitInjectionContext.
+// Nothing is rewritten until InitInjectionContext publishes an image.
 bool InitRuntimeHooks();
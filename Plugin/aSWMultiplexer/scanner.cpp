@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <filesystem>
 #include <cstring>
+#include <chrono>
 
 #include <zlib.h>
 
@@ -15,6 +16,7 @@
 #include "mapping.hpp"
 #include "diagnostics.h"
 #include "records.hpp"
+#include "stage_tracer.hpp"
 
 namespace fs = std::filesystem;
 
@@ -99,6 +101,82 @@ static bool inflate_payload(const std::vector<uint8_t>& src, std::vector<uint8_t
     return true;
 }
 
+// Compressed records are traced in batches rather than one span each:
+// a span per record would outweigh the inflate it measures.
+static constexpr uint32_t kTraceInflateBatchSize = 64;
+
+struct InflateTraceBatch
+{
+    const std::string* moduleName = nullptr;
+    uint64_t start = 0;
+    uint64_t inflateUs = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    uint32_t records = 0;
+
+    void Flush()
+    {
+        if (records == 0)
+            return;
+
+        std::vector<StageTraceArg> args(5);
+        args[0].key = "module";   args[0].text = *moduleName; args[0].isText = true;
+        args[1].key = "records";  args[1].number = records;
+        args[2].key = "bytesIn";  args[2].number = bytesIn;
+        args[3].key = "bytesOut"; args[3].number = bytesOut;
+        args[4].key = "inflateUs"; args[4].number = inflateUs;
+
+        StageTrace_Complete(TraceCat::Batch, "inflate batch", start, StageTrace_Now(), std::move(args));
+
+        start = inflateUs = bytesIn = bytesOut = 0;
+        records = 0;
+    }
+};
+
+// Collects ModuleScanStats for one record pass and publishes them to the
+// module on every exit path (missing file, bad header, truncated read, EOF).
+struct RecordScanStatsScope
+{
+    ModuleDescriptor& module;
+    ModuleScanStats stats;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    explicit RecordScanStatsScope(ModuleDescriptor& m)
+        : module(m)
+    {
+        stats.metadataScanned = m.scanStats.metadataScanned;
+        stats.metadataOk = m.scanStats.metadataOk;
+        stats.scanPasses = m.scanStats.scanPasses + 1;
+        stats.recordsScanned = true;
+    }
+
+    ~RecordScanStatsScope()
+    {
+        stats.scanMicros = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        module.scanStats = std::move(stats);
+    }
+
+    void CountType(uint32_t sig)
+    {
+        ++stats.recordsSeen;
+
+        // A plugin has a few dozen distinct signatures at most
+        for (RecordTypeCount& tc : stats.typeCounts) {
+            if (tc.type == sig) {
+                ++tc.count;
+                return;
+            }
+        }
+
+        RecordTypeCount tc;
+        tc.type = sig;
+        tc.count = 1;
+        stats.typeCounts.push_back(tc);
+    }
+};
+
 static void parse_lvli_subrecord(uint32_t subType, const uint8_t* data, uint16_t size, RecordPayload& out)
 {
     const uint32_t kLVLO = string_to_fourcc("LVLO");
@@ -158,7 +236,7 @@ static void parse_subrecords_buffer(const uint8_t* buffer, std::size_t bufferSiz
     }
 }
 
-static std::string find_plugin_path(const std::string& moduleName)
+std::string find_plugin_path(const std::string& moduleName)
 {
     char gamePath[MAX_PATH] = {};
     if (GetModuleFileNameA(nullptr, gamePath, MAX_PATH) == 0)
@@ -232,6 +310,8 @@ bool scan_plugin_metadata(const std::string& moduleName, ModuleDescriptor& out)
     out.eslSlot = 0;
     out.ba2Paths.clear();
     out.containsWorldspace = false;
+    out.scanStats.metadataScanned = true;
+    out.scanStats.metadataOk = false;
 
     std::string path = find_plugin_path(moduleName);
     if (path.empty())
@@ -264,9 +344,39 @@ bool scan_plugin_metadata(const std::string& moduleName, ModuleDescriptor& out)
     }
     out.eslSlot = static_cast<uint16_t>(h & 0x0FFFu);
 
+    // Worldspace detection: the same top-level walk as scan_plugin_records
+    // (and csvbuilder's FormTableScanPlugin), headers only, so modules the
+    // injector skips are known before any form map is built
+    const uint32_t kWRLD = string_to_fourcc("WRLD");
+    const uint32_t kCELL = string_to_fourcc("CELL");
+    const uint32_t kLAND = string_to_fourcc("LAND");
+    const uint32_t kNAVM = string_to_fourcc("NAVM");
+    const uint32_t kREFR = string_to_fourcc("REFR");
+    const uint32_t kACHR = string_to_fourcc("ACHR");
+
+    in.seekg(header.dataSize, std::ios::cur);
+    while (true)
+    {
+        GenericRecordHeader rh;
+        if (!read_exact(in, &rh, sizeof(rh)))
+            break;
+        if (rh.dataSize == 0)
+            continue;
+
+        const uint32_t sig = rh.type;
+        if (sig == kWRLD || sig == kCELL || sig == kLAND ||
+            sig == kNAVM || sig == kREFR || sig == kACHR)
+        {
+            out.containsWorldspace = true;
+            break;
+        }
+        in.seekg(rh.dataSize, std::ios::cur);
+    }
+
     // BA2 discovery
     out.ba2Paths = discover_ba2s(moduleName);
 
+    out.scanStats.metadataOk = true;
     return true;
 }
 
@@ -283,6 +393,12 @@ std::vector<RawRecord> scan_plugin_records(const std::string& moduleName, Module
 {
     std::vector<RawRecord> out;
 
+    StageTraceSpan scanSpan(TraceCat::Module, "scan_plugin_records");
+    scanSpan.AddArg("module", moduleName);
+
+    RecordScanStatsScope scope(module);
+    ModuleScanStats& stats = scope.stats;
+
     std::string path = find_plugin_path(moduleName);
     if (path.empty())
         return out;
@@ -291,12 +407,16 @@ std::vector<RawRecord> scan_plugin_records(const std::string& moduleName, Module
     if (!in)
         return out;
 
+    stats.fileFound = true;
+
     TES4RecordHeader tes4;
     std::memset(&tes4, 0, sizeof(tes4));
 
     if (!read_exact(in, &tes4, sizeof(tes4)))
         return out;
 
+    stats.bytesRead += sizeof(tes4);
+
     const uint32_t kTES4 = string_to_fourcc("TES4");
     if (tes4.type != kTES4)
         return out;
@@ -317,6 +437,10 @@ std::vector<RawRecord> scan_plugin_records(const std::string& moduleName, Module
 
     const uint32_t kCompressedFlag = 0x00040000u;
 
+    const bool tracing = scanSpan.Active();
+    InflateTraceBatch batch;
+    batch.moduleName = &moduleName;
+
     while (true)
     {
         GenericRecordHeader rh;
@@ -325,10 +449,13 @@ std::vector<RawRecord> scan_plugin_records(const std::string& moduleName, Module
         if (!read_exact(in, &rh, sizeof(rh)))
             break;
 
+        stats.bytesRead += sizeof(rh);
+
         if (rh.dataSize == 0)
             continue;
 
         uint32_t sig = rh.type;
+        scope.CountType(sig);
 
         bool isWorldspace =
             sig == kWRLD || sig == kCELL || sig == kLAND ||
@@ -351,6 +478,8 @@ std::vector<RawRecord> scan_plugin_records(const std::string& moduleName, Module
         if (!read_exact(in, payload.data(), payload.size()))
             break;
 
+        stats.bytesRead += payload.size();
+
         RawRecord rec;
         std::memset(&rec, 0, sizeof(rec));
 
@@ -359,19 +488,47 @@ std::vector<RawRecord> scan_plugin_records(const std::string& moduleName, Module
 
         if (rh.flags & kCompressedFlag)
         {
+            const uint64_t t0 = tracing ? StageTrace_Now() : 0;
+            if (tracing && batch.records == 0)
+                batch.start = t0;
+
             std::vector<uint8_t> decompressed;
-            if (!inflate_payload(payload, decompressed))
+            const bool inflated = inflate_payload(payload, decompressed);
+
+            if (tracing) {
+                batch.inflateUs += StageTrace_Now() - t0;
+                batch.bytesIn += payload.size();
+                batch.bytesOut += decompressed.size();
+                if (++batch.records == kTraceInflateBatchSize)
+                    batch.Flush();
+            }
+
+            if (!inflated) {
+                ++stats.inflateFailures;
                 continue;
+            }
 
+            ++stats.compressedCount;
+            stats.bytesInflated += decompressed.size();
             parse_subrecords_buffer(decompressed.data(), decompressed.size(), sig, rec.payload);
         }
         else
         {
+            ++stats.uncompressedCount;
             parse_subrecords_buffer(payload.data(), payload.size(), sig, rec.payload);
         }
 
         out.push_back(rec);
     }
 
+    stats.recordsCollected = static_cast<uint32_t>(out.size());
+
+    if (tracing) {
+        batch.Flush();
+        scanSpan.AddArg("records", out.size());
+        scanSpan.AddArg("bytesRead", stats.bytesRead);
+        scanSpan.AddArg("bytesInflated", stats.bytesInflated);
+    }
+
     return out;
 }
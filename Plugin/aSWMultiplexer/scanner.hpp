@@ -7,10 +7,13 @@
 #include "mapping.hpp"   // ModuleDescriptor
 #include "records.hpp"   // RawRecord, RecordPayload
 
+// Full path of Data\<moduleName> next to the game executable, or empty if absent
+std::string find_plugin_path(const std::string& moduleName);
+
 // Discover BA2 archives for a module (optional asset mounting support)
 std::vector<std::string> discover_ba2s(const std::string& moduleName);
 
-// Scan plugin metadata (TES4 header, ESL flag, FE slot)
+// Scan plugin metadata (TES4 header, ESL flag, FE slot, worldspace flag)
 bool scan_plugin_metadata(const std::string& moduleName, ModuleDescriptor& out);
 
 // Scan plugin records (KYWD / WEAP / ARMO / LVLI / etc.).
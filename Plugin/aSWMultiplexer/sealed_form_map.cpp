@@ -0,0 +1,122 @@
+#include "pch.h"
+#include "sealed_form_map.hpp"
+
+#include <algorithm>
+
+// Pilots tried per bucket before the whole build is retried with a new seed
+static constexpr std::uint32_t kMaxPilot = 1u << 16;
+
+void SealedFormMap::Build(const std::unordered_map<std::uint32_t, std::uint32_t>& map)
+{
+    std::vector<std::uint64_t> pairs;
+    pairs.reserve(map.size());
+    for (const auto& kv : map)
+        pairs.push_back((static_cast<std::uint64_t>(kv.first) << 32) | kv.second);
+
+    // Hash-map iteration order is unspecified; sort so the layout is reproducible
+    std::sort(pairs.begin(), pairs.end());
+
+    // A failed attempt is vanishingly rare; retry with a new seed
+    for (std::uint64_t attempt = 0; !TryBuild(pairs, Mix(attempt + 1)); ++attempt)
+        ;
+}
+
+bool SealedFormMap::TryBuild(const std::vector<std::uint64_t>& pairs, std::uint64_t seed)
+{
+    const std::uint32_t n = static_cast<std::uint32_t>(pairs.size());
+
+    m_seed = seed;
+    m_bucketCount = std::max<std::uint32_t>(1, (n + 3) / 4);
+    m_pilots.assign(m_bucketCount, 0);
+    m_entries.clear();
+
+    if (n == 0) {
+        m_pilots.shrink_to_fit();
+        m_entries.shrink_to_fit();
+        return true;
+    }
+
+    // Hash every key once and group the keys by bucket (counting sort)
+    std::vector<std::uint64_t> hashes(n);
+    std::vector<std::uint32_t> bucketStart(m_bucketCount + 1, 0);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        hashes[i] = Mix(static_cast<std::uint32_t>(pairs[i] >> 32) ^ seed);
+        ++bucketStart[Reduce(static_cast<std::uint32_t>(hashes[i] >> 32), m_bucketCount) + 1];
+    }
+    for (std::uint32_t b = 0; b < m_bucketCount; ++b)
+        bucketStart[b + 1] += bucketStart[b];
+
+    std::vector<std::uint32_t> members(n);
+    {
+        std::vector<std::uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+        for (std::uint32_t i = 0; i < n; ++i)
+            members[fill[Reduce(static_cast<std::uint32_t>(hashes[i] >> 32), m_bucketCount)]++] = i;
+    }
+
+    // Largest buckets first, while the table is emptiest
+    std::vector<std::uint32_t> order(m_bucketCount);
+    for (std::uint32_t b = 0; b < m_bucketCount; ++b)
+        order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+        return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+    });
+
+    std::vector<std::uint8_t> taken(n, 0);
+    std::vector<std::uint32_t> slotOf(n);
+    std::vector<std::uint32_t> tried;
+
+    std::size_t next = 0;
+    for (; next < order.size(); ++next)
+    {
+        const std::uint32_t b = order[next];
+        const std::uint32_t first = bucketStart[b];
+        const std::uint32_t size = bucketStart[b + 1] - first;
+        if (size < 2)
+            break;
+
+        std::uint32_t pilot = 0;
+        for (; pilot < kMaxPilot; ++pilot)
+        {
+            tried.clear();
+            bool fits = true;
+            for (std::uint32_t k = 0; k < size && fits; ++k)
+            {
+                const std::uint32_t slot = Reduce(static_cast<std::uint32_t>(Mix(hashes[members[first + k]] ^ (pilot * kPilotMul))), n);
+                fits = !taken[slot] && std::find(tried.begin(), tried.end(), slot) == tried.end();
+                tried.push_back(slot);
+            }
+            if (fits)
+                break;
+        }
+        if (pilot == kMaxPilot)
+            return false;
+
+        m_pilots[b] = pilot;
+        for (std::uint32_t k = 0; k < size; ++k) {
+            taken[tried[k]] = 1;
+            slotOf[members[first + k]] = tried[k];
+        }
+    }
+
+    // Single-key buckets take the remaining slots directly (empty buckets keep pilot 0)
+    std::uint32_t freeSlot = 0;
+    for (; next < order.size(); ++next)
+    {
+        const std::uint32_t b = order[next];
+        if (bucketStart[b + 1] == bucketStart[b])
+            break;
+
+        while (taken[freeSlot])
+            ++freeSlot;
+        taken[freeSlot] = 1;
+        slotOf[members[bucketStart[b]]] = freeSlot;
+        m_pilots[b] = kDirect | freeSlot;
+    }
+
+    m_entries.assign(n, 0);
+    for (std::uint32_t i = 0; i < n; ++i)
+        m_entries[slotOf[i]] = pairs[i];
+
+    m_pilots.shrink_to_fit();
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// ============================================================================
+// SealedFormMap
+//
+// Read-only local key -> FormID map built once from a finished formIdMap.
+// A minimal perfect hash (CHD / PTHash style): keys hash into buckets of
+// about four, each bucket stores a pilot that places all of its keys into
+// distinct slots of an n-entry table. Buckets of one key, placed last,
+// store their slot directly, so building always succeeds.
+//
+// Each slot packs key and value into one 64-bit word, so a lookup reads
+// one small pilot array (cache resident) and one table entry. About 9
+// bytes per key, against ~40 for a node-based std::unordered_map.
+// ============================================================================
+
+class SealedFormMap
+{
+public:
+    void Build(const std::unordered_map<std::uint32_t, std::uint32_t>& map);
+
+    bool Find(std::uint32_t key, std::uint32_t& outValue) const
+    {
+        if (m_entries.empty())
+            return false;
+
+        const std::uint64_t h = Mix(key ^ m_seed);
+        const std::uint32_t pilot = m_pilots[Reduce(static_cast<std::uint32_t>(h >> 32), m_bucketCount)];
+        const std::uint32_t slot = (pilot & kDirect) ?
+            (pilot & ~kDirect) :
+            Reduce(static_cast<std::uint32_t>(Mix(h ^ (pilot * kPilotMul))), static_cast<std::uint32_t>(m_entries.size()));
+
+        const std::uint64_t e = m_entries[slot];
+        if (static_cast<std::uint32_t>(e >> 32) != key)
+            return false;
+        outValue = static_cast<std::uint32_t>(e);
+        return true;
+    }
+
+    std::size_t Size() const { return m_entries.size(); }
+    bool Empty() const { return m_entries.empty(); }
+
+    // Entries in table order (not sorted)
+    std::uint32_t KeyAt(std::size_t i) const { return static_cast<std::uint32_t>(m_entries[i] >> 32); }
+    std::uint32_t ValueAt(std::size_t i) const { return static_cast<std::uint32_t>(m_entries[i]); }
+
+    std::size_t MemoryBytes() const
+    {
+        return m_entries.capacity() * sizeof(std::uint64_t) + m_pilots.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    static constexpr std::uint32_t kDirect = 0x80000000u;
+    static constexpr std::uint64_t kPilotMul = 0x9E3779B97F4A7C15ull;
+
+    // splitmix64 finalizer
+    static std::uint64_t Mix(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Maps a 32-bit hash onto [0, n) without a division
+    static std::uint32_t Reduce(std::uint32_t h, std::uint32_t n)
+    {
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(h) * n) >> 32);
+    }
+
+    bool TryBuild(const std::vector<std::uint64_t>& pairs, std::uint64_t seed);
+
+    std::vector<std::uint32_t> m_pilots;    // per bucket; kDirect | slot for single-key buckets
+    std::vector<std::uint64_t> m_entries;   // key << 32 | value
+    std::uint32_t m_bucketCount = 0;
+    std::uint64_t m_seed = 0;
+};
@@ -0,0 +1,191 @@
+#include "pch.h"
+#include "slot_manifest.hpp"
+#include "log.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+// ============================================================================
+// Validation helpers
+// ============================================================================
+
+// [offset, offset + count * elemSize) lies inside the file and is aligned
+static bool SectionFits(std::uint64_t fileSize, std::uint32_t offset, std::uint32_t count, std::size_t elemSize)
+{
+    if (offset % 4 != 0)
+        return false;
+    const std::uint64_t end = static_cast<std::uint64_t>(offset) + static_cast<std::uint64_t>(count) * elemSize;
+    return end <= fileSize;
+}
+
+static bool SourceMatches(const std::string& path, std::uint64_t size, std::int64_t writeTime)
+{
+    std::error_code ec;
+    const std::uintmax_t actualSize = std::filesystem::file_size(path, ec);
+    if (ec || actualSize != size)
+        return false;
+
+    const auto actualTime = std::filesystem::last_write_time(path, ec);
+    if (ec)
+        return false;
+
+    return static_cast<std::int64_t>(actualTime.time_since_epoch().count()) == writeTime;
+}
+
+// ============================================================================
+// SlotManifest
+// ============================================================================
+
+bool SlotManifest::Open(const std::string& manifestPath,
+    const std::string& csvPath,
+    const std::string& slotCfgPath,
+    std::string& outReason)
+{
+    m_header = nullptr;
+
+    if (!m_file.Open(manifestPath)) {
+        outReason = "not found";
+        return false;
+    }
+
+    const std::uint8_t* data = m_file.Data();
+    const std::size_t size = m_file.Size();
+
+    auto fail = [&](const char* reason) {
+        outReason = reason;
+        m_file.Close();
+        return false;
+    };
+
+    if (size < sizeof(SlotManifestHeader))
+        return fail("truncated header");
+
+    const SlotManifestHeader* h = reinterpret_cast<const SlotManifestHeader*>(data);
+
+    if (std::memcmp(h->magic, kSlotManifestMagic, sizeof(h->magic)) != 0)
+        return fail("bad magic");
+    if (h->version != kSlotManifestVersion)
+        return fail("unsupported version");
+    if (h->headerSize != sizeof(SlotManifestHeader) || h->fileSize != size)
+        return fail("size mismatch");
+    if (SlotManifestChecksum(data, size) != h->checksum)
+        return fail("checksum mismatch");
+
+    if (!SectionFits(size, h->stringOffset, h->stringCount, sizeof(SlotManifestString)) ||
+        !SectionFits(size, h->moduleOffset, h->moduleCount, sizeof(std::uint32_t)) ||
+        !SectionFits(size, h->slotOffset, h->slotCount, sizeof(SlotManifestSlot)) ||
+        !SectionFits(size, h->slotModOffset, h->slotModCount, sizeof(std::uint32_t)) ||
+        !SectionFits(size, h->aliasOffset, h->aliasCount, sizeof(SlotManifestAlias)) ||
+        !SectionFits(size, h->stringBlobOffset, h->stringBlobSize, 1))
+        return fail("section out of bounds");
+
+    const SlotManifestString* strings = reinterpret_cast<const SlotManifestString*>(data + h->stringOffset);
+    const std::uint32_t* modules = reinterpret_cast<const std::uint32_t*>(data + h->moduleOffset);
+    const SlotManifestSlot* slots = reinterpret_cast<const SlotManifestSlot*>(data + h->slotOffset);
+    const std::uint32_t* slotMods = reinterpret_cast<const std::uint32_t*>(data + h->slotModOffset);
+    const SlotManifestAlias* aliases = reinterpret_cast<const SlotManifestAlias*>(data + h->aliasOffset);
+    const char* blob = reinterpret_cast<const char*>(data + h->stringBlobOffset);
+
+    // Every reference is checked once here so the accessors need no checks
+    for (std::uint32_t i = 0; i < h->stringCount; ++i) {
+        const std::uint64_t end = static_cast<std::uint64_t>(strings[i].offset) + strings[i].length;
+        if (end >= h->stringBlobSize || blob[end] != '\0')
+            return fail("bad string entry");
+    }
+    for (std::uint32_t i = 0; i < h->moduleCount; ++i)
+        if (modules[i] >= h->stringCount)
+            return fail("bad module entry");
+    for (std::uint32_t i = 0; i < h->slotModCount; ++i)
+        if (slotMods[i] >= h->stringCount)
+            return fail("bad slot module entry");
+    for (std::uint32_t i = 0; i < h->slotCount; ++i) {
+        const SlotManifestSlot& s = slots[i];
+        if (s.dummyPlugin >= h->stringCount || s.category >= h->stringCount ||
+            static_cast<std::uint64_t>(s.firstMod) + s.modCount > h->slotModCount)
+            return fail("bad slot entry");
+    }
+    for (std::uint32_t i = 0; i < h->aliasCount; ++i)
+        if (aliases[i].from >= h->stringCount || aliases[i].to >= h->stringCount)
+            return fail("bad alias entry");
+
+    // Stale if either text source changed after the manifest was written
+    if (!SourceMatches(csvPath, h->csvSize, h->csvWriteTime))
+        return fail("stale (CSV changed or missing)");
+    if (!SourceMatches(slotCfgPath, h->slotCfgSize, h->slotCfgWriteTime))
+        return fail("stale (slot.cfg changed or missing)");
+
+    m_header = h;
+    m_strings = strings;
+    m_modules = modules;
+    m_slots = slots;
+    m_slotMods = slotMods;
+    m_aliases = aliases;
+    m_blob = blob;
+    return true;
+}
+
+std::string_view SlotManifest::String(std::uint32_t id) const
+{
+    const SlotManifestString& s = m_strings[id];
+    return std::string_view(m_blob + s.offset, s.length);
+}
+
+void SlotManifest::ToCsvSlots(std::vector<CSVSlot>& out) const
+{
+    out.reserve(out.size() + SlotCount());
+
+    for (std::uint32_t i = 0; i < SlotCount(); ++i)
+    {
+        const SlotManifestSlot& s = Slot(i);
+
+        CSVSlot row;
+        row.dummyPlugin = std::string(String(s.dummyPlugin));
+        row.virtualID = s.virtualId;
+        row.sourceMods.reserve(s.modCount);
+        for (std::uint32_t k = 0; k < s.modCount; ++k)
+            row.sourceMods.emplace_back(SlotMod(s, k));
+
+        out.push_back(std::move(row));
+    }
+}
+
+void SlotManifest::ToAliasMap(std::unordered_map<std::string, std::string>& out) const
+{
+    out.reserve(out.size() + AliasCount());
+
+    for (std::uint32_t i = 0; i < AliasCount(); ++i) {
+        const SlotManifestAlias& a = Alias(i);
+        out[std::string(String(a.from))] = std::string(String(a.to));
+    }
+}
+
+// ============================================================================
+// Process-wide instance
+// ============================================================================
+
+static SlotManifest g_slotManifest;
+
+bool SlotManifest_Load(const std::string& csvPath)
+{
+    const std::string dir = "Data\\F4SE\\Plugins\\Multiplexer\\";
+    const std::string manifestPath = dir + kSlotManifestFileName;
+
+    std::string reason;
+    if (!g_slotManifest.Open(manifestPath, csvPath, dir + "slot.cfg", reason)) {
+        logf("SlotManifest: %s %s - using text CSV / slot.cfg.", manifestPath.c_str(), reason.c_str());
+        return false;
+    }
+
+    logf("SlotManifest: loaded %s (%u CSV rows, %u modules, %u aliases).",
+        manifestPath.c_str(),
+        g_slotManifest.SlotCount(),
+        g_slotManifest.ModuleCount(),
+        g_slotManifest.AliasCount());
+    return true;
+}
+
+const SlotManifest* SlotManifest_Get()
+{
+    return g_slotManifest.IsOpen() ? &g_slotManifest : nullptr;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "slot_manifest_format.hpp"
+#include "csv_loader.hpp"    // CSVSlot
+
+// ============================================================================
+// SlotManifest
+//
+// Read-only view of slot_manifest.bin (see slot_manifest_format.hpp). Open()
+// maps the file and validates magic, version, checksum, section bounds and
+// the recorded CSV / slot.cfg size and mtime; the accessors then read the
+// mapping directly. Any failure leaves the manifest closed and callers fall
+// back to the text files.
+// ============================================================================
+
+class SlotManifest
+{
+public:
+    // Returns false (with a reason) if missing, corrupt or stale
+    bool Open(const std::string& manifestPath,
+        const std::string& csvPath,
+        const std::string& slotCfgPath,
+        std::string& outReason);
+
+    bool IsOpen() const { return m_header != nullptr; }
+
+    std::uint8_t FileIndex() const { return m_header->fileIndex; }
+
+    std::string_view String(std::uint32_t id) const;
+
+    std::uint32_t ModuleCount() const { return m_header->moduleCount; }
+    std::string_view ModuleName(std::uint32_t i) const { return String(m_modules[i]); }
+
+    std::uint32_t SlotCount() const { return m_header->slotCount; }
+    const SlotManifestSlot& Slot(std::uint32_t i) const { return m_slots[i]; }
+    std::string_view SlotMod(const SlotManifestSlot& slot, std::uint32_t k) const
+    {
+        return String(m_slotMods[slot.firstMod + k]);
+    }
+
+    std::uint32_t AliasCount() const { return m_header->aliasCount; }
+    const SlotManifestAlias& Alias(std::uint32_t i) const { return m_aliases[i]; }
+
+    // Materialize the CSV rows / alias map the text loaders would produce
+    void ToCsvSlots(std::vector<CSVSlot>& out) const;
+    void ToAliasMap(std::unordered_map<std::string, std::string>& out) const;
+
+private:
+    MappedFile m_file;
+    const SlotManifestHeader* m_header = nullptr;
+    const SlotManifestString* m_strings = nullptr;
+    const std::uint32_t* m_modules = nullptr;
+    const SlotManifestSlot* m_slots = nullptr;
+    const std::uint32_t* m_slotMods = nullptr;
+    const SlotManifestAlias* m_aliases = nullptr;
+    const char* m_blob = nullptr;
+};
+
+// Process-wide manifest, loaded once at startup from the Multiplexer folder.
+// Returns false (and logs why) when the text files must be used instead.
+bool SlotManifest_Load(const std::string& csvPath);
+
+// The loaded manifest, or nullptr when running from the text files
+const SlotManifest* SlotManifest_Get();
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ============================================================================
+// slot_manifest.bin — binary slot manifest
+//
+// Written by csvbuilder next to the CSV and slot.cfg it generates; read by
+// the plugin with one mapping and no text parsing. Shared by both projects,
+// so this header has no dependencies beyond <cstdint>.
+//
+// Layout (little-endian, every section 8-byte aligned):
+//
+//   SlotManifestHeader
+//   SlotManifestString[stringCount]    offset/length into the string blob
+//   uint32_t[moduleCount]              string ids (slot.cfg "modules")
+//   SlotManifestSlot[slotCount]        CSV rows
+//   uint32_t[slotModCount]             string ids; each slot owns a range
+//   SlotManifestAlias[aliasCount]      slot.cfg [Aliases]
+//   char[stringBlobSize]               NUL-terminated strings
+//
+// The checksum is FNV-1a 64 over the whole file with the checksum field
+// itself skipped. The source size/mtime fields let the plugin detect a CSV
+// or slot.cfg that was edited (or regenerated) after the manifest.
+// ============================================================================
+
+constexpr char          kSlotManifestMagic[4] = { 'M', 'X', 'S', 'M' };
+constexpr std::uint32_t kSlotManifestVersion = 1;
+constexpr const char*   kSlotManifestFileName = "slot_manifest.bin";
+
+#pragma pack(push, 1)
+
+struct SlotManifestHeader
+{
+    char          magic[4];
+    std::uint32_t version;
+    std::uint64_t checksum;
+
+    std::uint32_t headerSize;
+    std::uint32_t fileSize;
+
+    // Sources this manifest mirrors (std::filesystem file size and
+    // last_write_time().time_since_epoch().count())
+    std::uint64_t csvSize;
+    std::int64_t  csvWriteTime;
+    std::uint64_t slotCfgSize;
+    std::int64_t  slotCfgWriteTime;
+
+    std::uint8_t  fileIndex;
+    std::uint8_t  reserved[7];
+
+    std::uint32_t stringCount;
+    std::uint32_t stringOffset;
+    std::uint32_t moduleCount;
+    std::uint32_t moduleOffset;
+    std::uint32_t slotCount;
+    std::uint32_t slotOffset;
+    std::uint32_t slotModCount;
+    std::uint32_t slotModOffset;
+    std::uint32_t aliasCount;
+    std::uint32_t aliasOffset;
+    std::uint32_t stringBlobOffset;
+    std::uint32_t stringBlobSize;
+};
+
+struct SlotManifestString
+{
+    std::uint32_t offset;      // into the string blob
+    std::uint32_t length;      // excluding the NUL
+};
+
+struct SlotManifestSlot
+{
+    std::uint32_t dummyPlugin; // string id
+    std::uint32_t virtualId;
+    std::uint32_t category;    // string id
+    std::uint32_t firstMod;    // index into the slot-mod array
+    std::uint32_t modCount;
+    std::uint32_t reserved;
+};
+
+struct SlotManifestAlias
+{
+    std::uint32_t from;        // string id
+    std::uint32_t to;          // string id
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(SlotManifestHeader) == 112, "SlotManifestHeader layout changed");
+static_assert(sizeof(SlotManifestString) == 8, "SlotManifestString layout changed");
+static_assert(sizeof(SlotManifestSlot) == 24, "SlotManifestSlot layout changed");
+static_assert(sizeof(SlotManifestAlias) == 8, "SlotManifestAlias layout changed");
+
+inline std::uint64_t SlotManifestChecksum(const std::uint8_t* data, std::size_t size)
+{
+    constexpr std::size_t kSkipBegin = offsetof(SlotManifestHeader, checksum);
+    constexpr std::size_t kSkipEnd = kSkipBegin + sizeof(std::uint64_t);
+
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        if (i >= kSkipBegin && i < kSkipEnd)
+            continue;
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
@@ -0,0 +1,215 @@
+#include "pch.h"
+#include "stage_tracer.hpp"
+#include "report_writer.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// ============================================================================
+// Internal state
+// ============================================================================
+
+struct StageTraceEvent
+{
+    const char* category;
+    std::string name;
+    std::uint64_t start;
+    std::uint64_t duration;
+    std::uint32_t tid;
+    std::vector<StageTraceArg> args;
+};
+
+static std::atomic<bool> g_traceEnabled{ false };
+static std::mutex g_traceEventsMutex;
+static std::vector<StageTraceEvent> g_traceEvents;
+
+static const std::chrono::steady_clock::time_point g_traceOrigin = std::chrono::steady_clock::now();
+
+// Small dense thread IDs keep the viewer's track list readable
+static std::uint32_t CurrentTraceThreadId()
+{
+    static std::atomic<std::uint32_t> s_next{ 1 };
+    thread_local std::uint32_t t_id = s_next.fetch_add(1, std::memory_order_relaxed);
+    return t_id;
+}
+
+static void PushEvent(StageTraceEvent&& ev)
+{
+    std::lock_guard<std::mutex> lock(g_traceEventsMutex);
+    g_traceEvents.push_back(std::move(ev));
+}
+
+// ============================================================================
+// Session control
+// ============================================================================
+
+void StageTrace_Begin()
+{
+    {
+        std::lock_guard<std::mutex> lock(g_traceEventsMutex);
+        g_traceEvents.clear();
+        g_traceEvents.reserve(1024);
+    }
+    g_traceEnabled.store(true, std::memory_order_relaxed);
+}
+
+bool StageTrace_IsEnabled()
+{
+    return g_traceEnabled.load(std::memory_order_relaxed);
+}
+
+std::uint64_t StageTrace_Now()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - g_traceOrigin).count());
+}
+
+void StageTrace_Complete(const char* category, const std::string& name,
+    std::uint64_t startUs, std::uint64_t endUs,
+    std::vector<StageTraceArg> args)
+{
+    if (!StageTrace_IsEnabled())
+        return;
+
+    StageTraceEvent ev;
+    ev.category = category;
+    ev.name = name;
+    ev.start = startUs;
+    ev.duration = endUs > startUs ? endUs - startUs : 0;
+    ev.tid = CurrentTraceThreadId();
+    ev.args = std::move(args);
+    PushEvent(std::move(ev));
+}
+
+bool StageTrace_End(const std::string& path)
+{
+    if (!g_traceEnabled.exchange(false))
+        return true;
+
+    std::vector<StageTraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(g_traceEventsMutex);
+        events.swap(g_traceEvents);
+    }
+
+    // Parents before children when they start on the same microsecond
+    std::stable_sort(events.begin(), events.end(),
+        [](const StageTraceEvent& a, const StageTraceEvent& b) {
+            if (a.start != b.start)
+                return a.start < b.start;
+            return a.duration > b.duration;
+        });
+
+    BufferedReportWriter out;
+    if (!out.Open(path)) {
+        logf("StageTrace: could not open '%s' for writing.", path.c_str());
+        return false;
+    }
+
+    out.Write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    out.Write("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+        "\"args\":{\"name\":\"aSWMultiplexer\"}}");
+
+    for (const StageTraceEvent& ev : events)
+    {
+        out.Write(",\n{\"name\":");
+        out.WriteJsonString(ev.name);
+        out.Write(",\"cat\":\"");
+        out.Write(ev.category);
+        out.Write("\",\"ph\":\"X\",\"ts\":");
+        out.WriteUInt(ev.start);
+        out.Write(",\"dur\":");
+        out.WriteUInt(ev.duration);
+        out.Write(",\"pid\":1,\"tid\":");
+        out.WriteUInt(ev.tid);
+
+        if (!ev.args.empty())
+        {
+            out.Write(",\"args\":{");
+            for (std::size_t i = 0; i < ev.args.size(); ++i)
+            {
+                const StageTraceArg& a = ev.args[i];
+                if (i != 0)
+                    out.Put(',');
+                out.WriteJsonString(a.key);
+                out.Put(':');
+                if (a.isText)
+                    out.WriteJsonString(a.text);
+                else
+                    out.WriteUInt(a.number);
+            }
+            out.Put('}');
+        }
+        out.Put('}');
+    }
+
+    out.Write("\n]}\n");
+
+    if (!out.Close()) {
+        logf("StageTrace: write to '%s' failed.", path.c_str());
+        return false;
+    }
+
+    logf("StageTrace: %zu spans written to %s", events.size(), path.c_str());
+    return true;
+}
+
+// ============================================================================
+// StageTraceSpan
+// ============================================================================
+
+StageTraceSpan::StageTraceSpan(const char* category, const char* name)
+{
+    if (!StageTrace_IsEnabled())
+        return;
+
+    m_active = true;
+    m_category = category;
+    m_name = name;
+    m_start = StageTrace_Now();
+}
+
+StageTraceSpan::StageTraceSpan(const char* category, const std::string& name)
+{
+    if (!StageTrace_IsEnabled())
+        return;
+
+    m_active = true;
+    m_category = category;
+    m_name = name;
+    m_start = StageTrace_Now();
+}
+
+StageTraceSpan::~StageTraceSpan()
+{
+    if (!m_active)
+        return;
+
+    StageTrace_Complete(m_category, m_name, m_start, StageTrace_Now(), std::move(m_args));
+}
+
+void StageTraceSpan::AddArg(const char* key, std::uint64_t value)
+{
+    if (!m_active)
+        return;
+
+    StageTraceArg a;
+    a.key = key;
+    a.number = value;
+    m_args.push_back(std::move(a));
+}
+
+void StageTraceSpan::AddArg(const char* key, const std::string& value)
+{
+    if (!m_active)
+        return;
+
+    StageTraceArg a;
+    a.key = key;
+    a.text = value;
+    a.isText = true;
+    m_args.push_back(std::move(a));
+}
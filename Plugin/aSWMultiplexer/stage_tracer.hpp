@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Stage tracer
+//
+// Scoped timing spans written as Chrome trace-event JSON ("X" complete
+// events), loadable in chrome://tracing or ui.perfetto.dev. Spans nest by
+// time containment on the same thread: load -> stage -> module -> batch.
+//
+// Disabled by default (bEnableStageTrace). While disabled a span costs one
+// relaxed atomic load and stores nothing.
+// ============================================================================
+
+// Trace categories
+namespace TraceCat
+{
+    constexpr const char* Stage = "stage";
+    constexpr const char* Module = "module";
+    constexpr const char* Batch = "batch";
+}
+
+// Start collecting spans (clears any previous session)
+void StageTrace_Begin();
+
+// Stop collecting and write the trace file. Returns false on I/O failure.
+bool StageTrace_End(const std::string& path);
+
+bool StageTrace_IsEnabled();
+
+// Microseconds on the tracer's monotonic clock
+std::uint64_t StageTrace_Now();
+
+struct StageTraceArg
+{
+    const char* key = nullptr;
+    std::uint64_t number = 0;
+    std::string text;
+    bool isText = false;
+};
+
+// Record a span whose timing was measured by the caller (a stage that ran
+// before tracing was configured, or a batch accumulated across a loop)
+void StageTrace_Complete(const char* category, const std::string& name,
+    std::uint64_t startUs, std::uint64_t endUs,
+    std::vector<StageTraceArg> args = {});
+
+class StageTraceSpan
+{
+public:
+    StageTraceSpan(const char* category, const char* name);
+    StageTraceSpan(const char* category, const std::string& name);
+    ~StageTraceSpan();
+
+    StageTraceSpan(const StageTraceSpan&) = delete;
+    StageTraceSpan& operator=(const StageTraceSpan&) = delete;
+
+    // Shown in the viewer's detail pane; ignored while tracing is disabled
+    void AddArg(const char* key, std::uint64_t value);
+    void AddArg(const char* key, const std::string& value);
+
+    bool Active() const { return m_active; }
+
+private:
+    bool m_active = false;
+    const char* m_category = nullptr;
+    std::string m_name;
+    std::uint64_t m_start = 0;
+    std::vector<StageTraceArg> m_args;
+};
@@ -1,12 +1,30 @@
 #include "pch.h"
 #include "visibility.hpp"
 #include "mapping.hpp"
-#include "scanner.hpp"
 #include "log.hpp"
 #include "diagnostics.h"
+#include "config.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+static std::string fourcc_text(std::uint32_t v)
+{
+    char s[5];
+    s[0] = char(v & 0xFF);
+    s[1] = char((v >> 8) & 0xFF);
+    s[2] = char((v >> 16) & 0xFF);
+    s[3] = char((v >> 24) & 0xFF);
+    s[4] = '\0';
+    return std::string(s);
+}
 
 // ============================================================================
-// BuildVisibilitySnapshot (initial skeleton, updated to new architecture)
+// BuildVisibilitySnapshot
 // ============================================================================
 
 VisibilitySnapshot BuildVisibilitySnapshot(
@@ -26,44 +44,51 @@ VisibilitySnapshot BuildVisibilitySnapshot(
         //
         // Mapping info
         //
-        summary.slotFileIndex = slot.fileIndex;
+        summary.slotFileIndex = mod.slotFileIndex != 0xFF ? mod.slotFileIndex : slot.fileIndex;
         summary.inSlotConfig = true;   // All modules in SlotDescriptor come from slot.cfg
 
+        const ModuleScanStats& stats = mod.scanStats;
+
         //
         // Metadata info
         //
-        summary.metadataScanned = true;        // In your pipeline, metadata scan always runs
-        summary.metadataScanSuccess = true;    // scanner.cpp logs failures
+        summary.metadataScanned = stats.metadataScanned;
+        summary.metadataScanSuccess = stats.metadataOk;
 
         summary.isESL = mod.isESL;
         summary.pseudoEslSlot = mod.eslSlot;
         summary.ba2Paths = mod.ba2Paths;
 
-        if (mod.name.empty()) {
+        if (mod.name.empty() || (stats.metadataScanned && !stats.metadataOk)) {
             summary.metadataScanSuccess = false;
             summary.hadErrors = true;
         }
 
         //
-        // Record scan info (updated)
-        // Old world: module.records was pre-filled.
-        // New world: we query scan_plugin_records(mod.name) on demand.
+        // Record scan info (recorded by scan_plugin_records)
         //
-        std::vector<RawRecord> recs = scan_plugin_records(mod.name);
+        summary.recordsScanned = stats.recordsScanned;
+        summary.containsWorldspace = mod.containsWorldspace;
+        summary.recordCount = stats.recordsCollected;
+        summary.compressedCount = stats.compressedCount;
+        summary.uncompressedCount = stats.uncompressedCount;
+        summary.inflateFailures = stats.inflateFailures;
+        summary.recordsSeen = stats.recordsSeen;
+        summary.bytesRead = stats.bytesRead;
+        summary.bytesInflated = stats.bytesInflated;
+        summary.scanMicros = stats.scanMicros;
+        summary.scanPasses = stats.scanPasses;
+        summary.typeCounts = stats.typeCounts;
 
-        summary.recordsScanned = true;
-        summary.recordCount = recs.size();
+        if (stats.recordsScanned && !stats.fileFound)
+            summary.hadErrors = true;
 
-        // We no longer track per-record compression state in RawRecord.
-        // For now, treat them all as "uncompressed" in the summary.
-        summary.uncompressedCount = recs.size();
-        summary.compressedCount = 0;
+        if (stats.inflateFailures != 0)
+            summary.hadWarnings = true;
 
-        // Error/warning heuristic:
-        // If the module has a name but produced zero records, flag a warning.
-        if (!mod.name.empty() && summary.recordCount == 0) {
+        // A scanned, non-worldspace module that produced zero records is suspicious
+        if (stats.recordsScanned && !mod.containsWorldspace && summary.recordCount == 0)
             summary.hadWarnings = true;
-        }
 
         snapshot.modules.push_back(std::move(summary));
     }
@@ -118,9 +143,24 @@ void DumpVisibilitySnapshotToLog(const VisibilitySnapshot& snapshot)
         // Record scan
         //
         logf("  Records scanned: %s", m.recordsScanned ? "yes" : "no");
-        logf("  Total records: %zu", m.recordCount);
-        logf("    Uncompressed: %zu", m.uncompressedCount);
-        logf("    Compressed:   %zu", m.compressedCount);
+        if (m.recordsScanned) {
+            logf("  Scan passes: %u (last: %.3f ms)", m.scanPasses, m.scanMicros / 1000.0);
+            logf("  Contains worldspace: %s", m.containsWorldspace ? "yes" : "no");
+            logf("  Records seen: %zu", m.recordsSeen);
+            logf("  Total records: %zu", m.recordCount);
+            logf("    Uncompressed: %zu", m.uncompressedCount);
+            logf("    Compressed:   %zu", m.compressedCount);
+            if (m.inflateFailures != 0)
+                logf("    Inflate failures: %zu", m.inflateFailures);
+            logf("  Bytes read: %llu", static_cast<unsigned long long>(m.bytesRead));
+            logf("  Bytes inflated: %llu", static_cast<unsigned long long>(m.bytesInflated));
+
+            if (!m.typeCounts.empty()) {
+                logf("  Record types:");
+                for (const auto& tc : m.typeCounts)
+                    logf("    %s: %u", fourcc_text(tc.type).c_str(), tc.count);
+            }
+        }
 
         //
         // Issues
@@ -146,3 +186,406 @@ void DumpVisibilitySnapshotToLog(const VisibilitySnapshot& snapshot)
         "Visibility snapshot dump complete"
     );
 }
+
+// ============================================================================
+// Persisted snapshot (visibility.bin)
+//
+// Little-endian, fixed-width fields:
+//   "MXVS" | u32 version | u8 slotFileIndex | u32 moduleCount
+//   per module: u16 nameLen | name | u8 slotFileIndex | u8 flags |
+//               u16 pseudoEslSlot | u32 recordCount | u32 compressed |
+//               u32 uncompressed | u32 inflateFailures | u32 recordsSeen |
+//               u32 scanPasses | u64 bytesRead | u64 bytesInflated
+//   u32 FNV-1a of everything above
+// ============================================================================
+
+static const char kVisibilityMagic[4] = { 'M', 'X', 'V', 'S' };
+static constexpr std::uint32_t kVisibilityVersion = 1;
+static const char* kVisibilitySnapshotPath = "Data\\F4SE\\Plugins\\Multiplexer\\visibility.bin";
+
+enum : std::uint8_t
+{
+    kVisInSlotConfig       = 0x01,
+    kVisMetadataScanned    = 0x02,
+    kVisMetadataOk         = 0x04,
+    kVisESL                = 0x08,
+    kVisRecordsScanned     = 0x10,
+    kVisWorldspace         = 0x20,
+    kVisErrors             = 0x40,
+    kVisWarnings           = 0x80,
+};
+
+static std::uint32_t fnv1a(const char* data, std::size_t size)
+{
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        h ^= static_cast<unsigned char>(data[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+template <typename T>
+static void put_pod(std::string& buf, T value)
+{
+    buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static bool get_pod(const std::vector<char>& buf, std::size_t& pos, T& value)
+{
+    if (buf.size() - pos < sizeof(T))
+        return false;
+    std::memcpy(&value, buf.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+static std::uint8_t pack_flags(const ModuleScanSummary& m)
+{
+    std::uint8_t f = 0;
+    if (m.inSlotConfig)        f |= kVisInSlotConfig;
+    if (m.metadataScanned)     f |= kVisMetadataScanned;
+    if (m.metadataScanSuccess) f |= kVisMetadataOk;
+    if (m.isESL)               f |= kVisESL;
+    if (m.recordsScanned)      f |= kVisRecordsScanned;
+    if (m.containsWorldspace)  f |= kVisWorldspace;
+    if (m.hadErrors)           f |= kVisErrors;
+    if (m.hadWarnings)         f |= kVisWarnings;
+    return f;
+}
+
+static void unpack_flags(std::uint8_t f, ModuleScanSummary& m)
+{
+    m.inSlotConfig = (f & kVisInSlotConfig) != 0;
+    m.metadataScanned = (f & kVisMetadataScanned) != 0;
+    m.metadataScanSuccess = (f & kVisMetadataOk) != 0;
+    m.isESL = (f & kVisESL) != 0;
+    m.recordsScanned = (f & kVisRecordsScanned) != 0;
+    m.containsWorldspace = (f & kVisWorldspace) != 0;
+    m.hadErrors = (f & kVisErrors) != 0;
+    m.hadWarnings = (f & kVisWarnings) != 0;
+}
+
+bool SaveVisibilitySnapshot(const VisibilitySnapshot& snapshot, const std::string& path)
+{
+    std::string buf;
+    buf.reserve(16 + snapshot.modules.size() * 64);
+
+    buf.append(kVisibilityMagic, sizeof(kVisibilityMagic));
+    put_pod<std::uint32_t>(buf, kVisibilityVersion);
+    put_pod<std::uint8_t>(buf, snapshot.slotFileIndex);
+    put_pod<std::uint32_t>(buf, static_cast<std::uint32_t>(snapshot.modules.size()));
+
+    for (const auto& m : snapshot.modules)
+    {
+        const std::size_t nameLen = std::min<std::size_t>(m.name.size(), 0xFFFF);
+        put_pod<std::uint16_t>(buf, static_cast<std::uint16_t>(nameLen));
+        buf.append(m.name.data(), nameLen);
+
+        put_pod<std::uint8_t>(buf, m.slotFileIndex);
+        put_pod<std::uint8_t>(buf, pack_flags(m));
+        put_pod<std::uint16_t>(buf, m.pseudoEslSlot);
+        put_pod<std::uint32_t>(buf, static_cast<std::uint32_t>(m.recordCount));
+        put_pod<std::uint32_t>(buf, static_cast<std::uint32_t>(m.compressedCount));
+        put_pod<std::uint32_t>(buf, static_cast<std::uint32_t>(m.uncompressedCount));
+        put_pod<std::uint32_t>(buf, static_cast<std::uint32_t>(m.inflateFailures));
+        put_pod<std::uint32_t>(buf, static_cast<std::uint32_t>(m.recordsSeen));
+        put_pod<std::uint32_t>(buf, m.scanPasses);
+        put_pod<std::uint64_t>(buf, m.bytesRead);
+        put_pod<std::uint64_t>(buf, m.bytesInflated);
+    }
+
+    put_pod<std::uint32_t>(buf, fnv1a(buf.data(), buf.size()));
+
+    // Write-then-rename so a crash mid-write never leaves a torn baseline
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            logf("Visibility: could not open '%s' for writing.", tmpPath.c_str());
+            return false;
+        }
+        out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        if (!out.good()) {
+            logf("Visibility: write to '%s' failed.", tmpPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        logf("Visibility: could not replace '%s' (%s).", path.c_str(), ec.message().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool LoadVisibilitySnapshot(const std::string& path, VisibilitySnapshot& out)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    std::vector<char> buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (buf.size() < sizeof(kVisibilityMagic) + 4 + 1 + 4 + 4 ||
+        std::memcmp(buf.data(), kVisibilityMagic, sizeof(kVisibilityMagic)) != 0)
+    {
+        logf("Visibility: '%s' is not a snapshot file; ignoring.", path.c_str());
+        return false;
+    }
+
+    std::uint32_t storedHash = 0;
+    std::memcpy(&storedHash, buf.data() + buf.size() - 4, 4);
+    if (fnv1a(buf.data(), buf.size() - 4) != storedHash) {
+        logf("Visibility: '%s' failed checksum; ignoring.", path.c_str());
+        return false;
+    }
+    buf.resize(buf.size() - 4);
+
+    std::size_t pos = sizeof(kVisibilityMagic);
+    std::uint32_t version = 0;
+    std::uint32_t count = 0;
+
+    if (!get_pod(buf, pos, version) || version != kVisibilityVersion) {
+        logf("Visibility: '%s' has unsupported version %u; ignoring.", path.c_str(), version);
+        return false;
+    }
+
+    VisibilitySnapshot snap;
+    if (!get_pod(buf, pos, snap.slotFileIndex) || !get_pod(buf, pos, count))
+        return false;
+
+    snap.modules.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        ModuleScanSummary m;
+        std::uint16_t nameLen = 0;
+        if (!get_pod(buf, pos, nameLen) || buf.size() - pos < nameLen)
+            return false;
+        m.name.assign(buf.data() + pos, nameLen);
+        pos += nameLen;
+
+        std::uint8_t flags = 0;
+        std::uint32_t recordCount = 0, compressed = 0, uncompressed = 0, inflateFailures = 0, recordsSeen = 0;
+
+        const bool ok =
+            get_pod(buf, pos, m.slotFileIndex) &&
+            get_pod(buf, pos, flags) &&
+            get_pod(buf, pos, m.pseudoEslSlot) &&
+            get_pod(buf, pos, recordCount) &&
+            get_pod(buf, pos, compressed) &&
+            get_pod(buf, pos, uncompressed) &&
+            get_pod(buf, pos, inflateFailures) &&
+            get_pod(buf, pos, recordsSeen) &&
+            get_pod(buf, pos, m.scanPasses) &&
+            get_pod(buf, pos, m.bytesRead) &&
+            get_pod(buf, pos, m.bytesInflated);
+        if (!ok)
+            return false;
+
+        unpack_flags(flags, m);
+        m.recordCount = recordCount;
+        m.compressedCount = compressed;
+        m.uncompressedCount = uncompressed;
+        m.inflateFailures = inflateFailures;
+        m.recordsSeen = recordsSeen;
+
+        snap.modules.push_back(std::move(m));
+    }
+
+    out = std::move(snap);
+    return true;
+}
+
+// ============================================================================
+// Diff
+// ============================================================================
+
+static std::string lower_name(const std::string& s)
+{
+    std::string r = s;
+    std::transform(r.begin(), r.end(), r.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return r;
+}
+
+// Fields that survive persistence; timing and pass counts are not compared
+static bool same_persisted_state(const ModuleScanSummary& a, const ModuleScanSummary& b)
+{
+    return a.slotFileIndex == b.slotFileIndex &&
+        pack_flags(a) == pack_flags(b) &&
+        a.pseudoEslSlot == b.pseudoEslSlot &&
+        a.recordCount == b.recordCount &&
+        a.compressedCount == b.compressedCount &&
+        a.uncompressedCount == b.uncompressedCount &&
+        a.inflateFailures == b.inflateFailures &&
+        a.recordsSeen == b.recordsSeen &&
+        a.bytesRead == b.bytesRead;
+}
+
+VisibilityDiff DiffVisibilitySnapshots(const VisibilitySnapshot& previous, const VisibilitySnapshot& current)
+{
+    VisibilityDiff diff;
+    diff.hadPrevious = true;
+    diff.previousSlotFileIndex = previous.slotFileIndex;
+    diff.currentSlotFileIndex = current.slotFileIndex;
+
+    std::unordered_map<std::string, const ModuleScanSummary*> prevByName;
+    prevByName.reserve(previous.modules.size());
+    for (const auto& m : previous.modules)
+        prevByName.emplace(lower_name(m.name), &m);
+
+    for (const auto& m : current.modules)
+    {
+        auto it = prevByName.find(lower_name(m.name));
+        if (it == prevByName.end()) {
+            diff.added.push_back(&m);
+            continue;
+        }
+
+        if (same_persisted_state(*it->second, m)) {
+            ++diff.unchangedCount;
+        }
+        else {
+            ModuleVisibilityChange c;
+            c.name = m.name;
+            c.previous = it->second;
+            c.current = &m;
+            diff.changed.push_back(std::move(c));
+        }
+
+        prevByName.erase(it);
+    }
+
+    // Whatever was not matched is gone; report in previous-snapshot order
+    for (const auto& m : previous.modules)
+    {
+        if (prevByName.count(lower_name(m.name)))
+            diff.removed.push_back(&m);
+    }
+
+    return diff;
+}
+
+static std::string signed_delta(std::size_t before, std::size_t after)
+{
+    const long long d = static_cast<long long>(after) - static_cast<long long>(before);
+    return (d >= 0 ? "+" : "") + std::to_string(d);
+}
+
+static std::string describe_change(const ModuleScanSummary& a, const ModuleScanSummary& b)
+{
+    std::string out;
+    auto add = [&](const std::string& part) {
+        if (!out.empty())
+            out += ", ";
+        out += part;
+        };
+
+    if (a.recordCount != b.recordCount)
+        add("records " + std::to_string(a.recordCount) + " -> " + std::to_string(b.recordCount) +
+            " (" + signed_delta(a.recordCount, b.recordCount) + ")");
+    if (a.compressedCount != b.compressedCount)
+        add("compressed " + signed_delta(a.compressedCount, b.compressedCount));
+    if (a.uncompressedCount != b.uncompressedCount)
+        add("uncompressed " + signed_delta(a.uncompressedCount, b.uncompressedCount));
+    if (a.recordsSeen != b.recordsSeen)
+        add("records seen " + signed_delta(a.recordsSeen, b.recordsSeen));
+    if (a.bytesRead != b.bytesRead)
+        add("bytes read " + signed_delta(static_cast<std::size_t>(a.bytesRead), static_cast<std::size_t>(b.bytesRead)));
+    if (a.inflateFailures != b.inflateFailures)
+        add("inflate failures " + std::to_string(a.inflateFailures) + " -> " + std::to_string(b.inflateFailures));
+    if (a.isESL != b.isESL)
+        add(std::string("ESL ") + (a.isESL ? "yes" : "no") + " -> " + (b.isESL ? "yes" : "no"));
+    if (a.pseudoEslSlot != b.pseudoEslSlot) {
+        char tmp[48];
+        std::snprintf(tmp, sizeof(tmp), "pseudo FE slot 0x%03X -> 0x%03X", a.pseudoEslSlot, b.pseudoEslSlot);
+        add(tmp);
+    }
+    if (a.slotFileIndex != b.slotFileIndex) {
+        char tmp[48];
+        std::snprintf(tmp, sizeof(tmp), "slot 0x%02X -> 0x%02X", a.slotFileIndex, b.slotFileIndex);
+        add(tmp);
+    }
+    if (a.containsWorldspace != b.containsWorldspace)
+        add(std::string("worldspace ") + (b.containsWorldspace ? "now detected" : "no longer detected"));
+    if (a.metadataScanSuccess != b.metadataScanSuccess)
+        add(std::string("metadata ") + (b.metadataScanSuccess ? "now ok" : "now failing"));
+    if (a.hadErrors != b.hadErrors || a.hadWarnings != b.hadWarnings)
+        add(std::string("issues: ") + (b.hadErrors ? "errors" : b.hadWarnings ? "warnings" : "none"));
+    if (a.inSlotConfig != b.inSlotConfig || a.recordsScanned != b.recordsScanned || a.metadataScanned != b.metadataScanned)
+        add("scan coverage changed");
+
+    return out;
+}
+
+void DumpVisibilityDiffToLog(const VisibilityDiff& diff)
+{
+    const std::size_t total = diff.added.size() + diff.changed.size() + diff.unchangedCount;
+
+    if (diff.Empty()) {
+        logf("Visibility: no changes since previous launch (%zu modules).", total);
+        return;
+    }
+
+    logf("=== Visibility diff vs previous launch ===");
+
+    if (diff.previousSlotFileIndex != diff.currentSlotFileIndex)
+        logf("Slot fileIndex: 0x%02X -> 0x%02X", diff.previousSlotFileIndex, diff.currentSlotFileIndex);
+
+    logf("Modules: %zu (added %zu, removed %zu, changed %zu, unchanged %zu)",
+        total, diff.added.size(), diff.removed.size(), diff.changed.size(), diff.unchangedCount);
+
+    for (const ModuleScanSummary* m : diff.added)
+    {
+        logf("  + %s (records=%zu, compressed=%zu, ESL=%s%s)",
+            m->name.c_str(), m->recordCount, m->compressedCount,
+            m->isESL ? "yes" : "no",
+            m->containsWorldspace ? ", worldspace" : "");
+    }
+
+    for (const ModuleScanSummary* m : diff.removed)
+        logf("  - %s", m->name.c_str());
+
+    for (const auto& c : diff.changed)
+        logf("  ~ %s: %s", c.name.c_str(), describe_change(*c.previous, *c.current).c_str());
+
+    logf("=== End visibility diff ===");
+
+    Diagnostics_RecordEvent(
+        DiagnosticsEventType::Info,
+        "Visibility diff: +" + std::to_string(diff.added.size()) +
+        " -" + std::to_string(diff.removed.size()) +
+        " ~" + std::to_string(diff.changed.size())
+    );
+}
+
+// ============================================================================
+// PublishVisibilitySnapshot
+// ============================================================================
+
+void PublishVisibilitySnapshot(const VisibilitySnapshot& snapshot)
+{
+    if (g_visibilityLogMode == 2) {
+        DumpVisibilitySnapshotToLog(snapshot);
+    }
+    else if (g_visibilityLogMode == 1) {
+        VisibilitySnapshot previous;
+        if (LoadVisibilitySnapshot(kVisibilitySnapshotPath, previous)) {
+            DumpVisibilityDiffToLog(DiffVisibilitySnapshots(previous, snapshot));
+        }
+        else {
+            logf("Visibility: no previous snapshot; saved a baseline of %zu modules "
+                "(set iVisibilityLogMode=2 for the full dump).", snapshot.modules.size());
+        }
+    }
+
+    // Saved in every mode (0 only silences the log), so turning the log
+    // back on still diffs against the last session
+    SaveVisibilitySnapshot(snapshot, kVisibilitySnapshotPath);
+}
@@ -4,8 +4,7 @@
 #include <vector>
 #include <cstdint>
 
-struct SlotDescriptor;
-struct ModuleDescriptor;
+#include "mapping.hpp"   // ModuleScanStats, RecordTypeCount
 
 // ============================================================================
 // Visibility data structures
@@ -26,11 +25,19 @@ struct ModuleScanSummary
     uint16_t pseudoEslSlot = 0;
     std::vector<std::string> ba2Paths;
 
-    // Records
+    // Records (from the scanner's ModuleScanStats; no re-read)
     bool recordsScanned = false;
+    bool containsWorldspace = false;
     std::size_t recordCount = 0;
     std::size_t compressedCount = 0;
     std::size_t uncompressedCount = 0;
+    std::size_t inflateFailures = 0;
+    std::size_t recordsSeen = 0;
+    std::uint64_t bytesRead = 0;
+    std::uint64_t bytesInflated = 0;
+    std::uint64_t scanMicros = 0;
+    std::uint32_t scanPasses = 0;
+    std::vector<RecordTypeCount> typeCounts;
 
     // Aggregated issues
     bool hadErrors = false;
@@ -43,14 +50,58 @@ struct VisibilitySnapshot
     std::vector<ModuleScanSummary> modules;
 };
 
+// One module present in both snapshots whose persisted fields differ.
+struct ModuleVisibilityChange
+{
+    std::string name;
+    const ModuleScanSummary* previous = nullptr;   // points into the diffed snapshots
+    const ModuleScanSummary* current = nullptr;
+};
+
+// Difference between the previous launch's snapshot and this one.
+// Only meaningful while both source snapshots are alive.
+struct VisibilityDiff
+{
+    bool hadPrevious = false;
+    std::uint8_t previousSlotFileIndex = 0xFF;
+    std::uint8_t currentSlotFileIndex = 0xFF;
+
+    std::vector<const ModuleScanSummary*> added;
+    std::vector<const ModuleScanSummary*> removed;
+    std::vector<ModuleVisibilityChange> changed;
+    std::size_t unchangedCount = 0;
+
+    bool Empty() const
+    {
+        return previousSlotFileIndex == currentSlotFileIndex &&
+            added.empty() && removed.empty() && changed.empty();
+    }
+};
+
 // ============================================================================
 // API
 // ============================================================================
 
 // Build a visibility snapshot from the slot descriptor and module descriptors.
+// Uses the statistics recorded by the metadata/record scans; performs no I/O.
 VisibilitySnapshot BuildVisibilitySnapshot(
     const SlotDescriptor& slot,
     const std::vector<ModuleDescriptor>& modules);
 
 // Dump a human-readable summary to logf and diagnostics.
 void DumpVisibilitySnapshotToLog(const VisibilitySnapshot& snapshot);
+
+// Persist / reload a snapshot in the compact binary format (visibility.bin).
+// BA2 paths and per-type counts are not persisted; the diff does not use them.
+bool SaveVisibilitySnapshot(const VisibilitySnapshot& snapshot, const std::string& path);
+bool LoadVisibilitySnapshot(const std::string& path, VisibilitySnapshot& out);
+
+// Compare two snapshots; modules are matched by name (case-insensitive).
+VisibilityDiff DiffVisibilitySnapshots(const VisibilitySnapshot& previous, const VisibilitySnapshot& current);
+
+// Log only what changed since the previous snapshot.
+void DumpVisibilityDiffToLog(const VisibilityDiff& diff);
+
+// End-of-load entry point: log per iVisibilityLogMode (off / diff / full),
+// then replace the persisted snapshot with the current one (in every mode).
+void PublishVisibilitySnapshot(const VisibilitySnapshot& snapshot);